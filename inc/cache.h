@@ -1,53 +1,121 @@
 #ifndef CACHE_H
 #define CACHE_H
 
-// L1 data cache mapping for U Tokyo Shioya Lab RSD(RaiShouDou) CPU
-// Refer to https://github.com/rsd-devel/rsd/blob/master/Processor/Src/MicroArchConf.sv
-#define L1_DCACHE_WAYS 2 // Degree of associativity N = 2. i.e. 2-way set associative. In the link above: "CONF_DCACHE_WAY_NUM = 2"
-#define L1_DCACHE_BLOCK_BYTES 8 // b = 8Byte. In the link above: "CONF_DCACHE_LINE_BYTE_NUM = 8"
-#define L1_DCACHE_BLOCK_BITS 3 // = log2(b).
-#define L1_DCACHE_SETS 256 // 2048 for 32KB. Used to be 256 (for 4KB D$). S = 2^L1_DCACHE_SETS_BITS.
-// Ref: S=B/N=C/Nb. C=32KiB, L1_DCACHE_WAYS=N=2, b=8Byte, S=32KiB/(2x8Byte)=2KB=2048B.
-#define L1_DCACHE_SETS_BITS 8 // 2048 for 32KB. Used to be 8 (for 4KB D$). = log2(S). In the link above: "CONF_DCACHE_INDEX_BIT_WIDTH = 9 - $clog2(CONF_DCACHE_WAY_NUM)"
-#define L1_DCACHE_CAPACITY_BYTES (L1_DCACHE_SETS*L1_DCACHE_WAYS*L1_DCACHE_BLOCK_BYTES) // Cache Capacity C=Bb=SNb=256*2*8Byte=4KiB
-#define FULL_MASK 0xFFFFFFFF // The address size is 32 bits. Refer to https://github.com/rsd-devel/rsd/blob/master/Processor/Src/BasicTypes.sv "ADDR_WIDTH = 32"
+#include "cache_conf.h"
+
+// Set up an empty array to put into the cache during the following cache flush (sized by MULTIPLIER in cache_conf.h).
+// It is split into way-sized slices. Each slice is aligned to L1_DCACHE_WAY_BYTES, so that its set bits start from 0
+// and the same offset in every slice maps to the same set with a different tag, i.e. is a candidate eviction line.
+RSD_NOINIT uint8_t dummyMem[EVICTION_SET_MAX_LINES * L1_DCACHE_WAY_BYTES] __attribute__((aligned(L1_DCACHE_WAY_BYTES)));
+// Temporary variable.
+uint8_t flush_junk = 0;
+
 /**
- * Sv39 virtual memory translation:
- * Instruction fetch addresses and load and store effective addresses, which are 64 bits,
- * must have bits 63–39 all equal to bit 38, or else a page-fault exception will occur.
+ * Flat table of eviction lines: evictionBase[j] + set offset is the j-th line congruent with that set.
+ * Only the first evictionLines entries are walked by flushCache().
+ * evictionSetInit() fills the table and selects all of it, calibrateEvictionSet() narrows it down.
  */
-#define OFFSET_MASK (~(FULL_MASK << L1_DCACHE_BLOCK_BITS)) // Offset bits are 0 to (L1_DCACHE_BLOCK_BITS - 1).
-// After this definition, only offset bits remain 1, and they are used to discover existence of any cache set in use.
-#define TAG_MASK (FULL_MASK << (L1_DCACHE_SETS_BITS + L1_DCACHE_BLOCK_BITS))
-// After this definition, only tag bits remain 1, and they are used to align memory.
-#define SET_MASK (~(TAG_MASK | OFFSET_MASK))
-// After this definition, only set bits remain 1, and they are used to clear tag and offset field of input addr.
-
-/* ----------------------------------
- * | Cache fields for a mapped memory address |
- * The LSBs (Least Significant Bits) of the address specify which set holds the data.
- * - Block offset. 32-bit RISC-V processors do not need "byte offset" for 32-bit addresses.
- * - The next several bits are called the "set bits" because they indicate the set to which the address maps.
- * The remaining MSBs (Most Significant Bits) are the "tag" and indicate which of the many possible addresses is held in that set.
- * ----------------------------------
- * | Tag (within a set) |  Set bits (index of set)  |       Block offset     |
- * ----------------------------------
- * |   <--Remaining-->  |       <--log2(S) -->      |     <--log2(b) -->    |
- * ----------------------------------
+uint8_t* evictionBase[EVICTION_SET_MAX_LINES];
+uint32_t evictionLines = 0;
+
+void evictionSetInit(){
+    for (uint32_t j = 0; j < EVICTION_SET_MAX_LINES; ++j){
+        evictionBase[j] = dummyMem + j * L1_DCACHE_WAY_BYTES;
+    }
+    evictionLines = EVICTION_SET_MAX_LINES;
+}
+
+/**
+ * Time one read of the byte at addr and leave the mcycle difference in diff.
+ * cacheAttack() and the calibrations below use this exact sequence, so that their thresholds agree.
+ * The 2 mcycle reads and the load are one asm block: nothing else can be scheduled between them at any optimization level,
+ * and the value is folded into junk only after the second read.
  */
+#define TIMED_READ(diff, addr, junk) do { \
+	register uint32_t __start, __end, __value; \
+	asm volatile("csrr	%[start], mcycle\n" \
+		"lbu	%[value], 0(%[address])\n" \
+		"csrr	%[end], mcycle\n" \
+		: [start] "=&r" (__start), [value] "=&r" (__value), [end] "=r" (__end) \
+		: [address] "r" (addr) \
+		: "memory"); \
+	(diff) = __end - __start; \
+	(junk) ^= __value; \
+	} while (0)
+
+/**
+ * Load one byte of every cache line in [first, last) and fold it into junk: the walk of flushCache().
+ * An asm loop, so that the compiler can neither drop, merge nor reorder the loads at any optimization level.
+ */
+#define TOUCH_LINES(first, last, junk) do { \
+	register uint8_t* __line = (first); \
+	register uint32_t __junk = (junk); \
+	register uint32_t __value; \
+	asm volatile("bgeu	%[cursor], %[limit], 2f\n" \
+		"1:\n" \
+		"lbu	%[value], 0(%[cursor])\n" \
+		"xor	%[acc], %[acc], %[value]\n" \
+		"addi	%[cursor], %[cursor], %[step]\n" \
+		"bltu	%[cursor], %[limit], 1b\n" \
+		"2:\n" \
+		: [cursor] "+r" (__line), [acc] "+r" (__junk), [value] "=&r" (__value) \
+		: [limit] "r" (last), [step] "i" (L1_DCACHE_BLOCK_BYTES) \
+		: "memory"); \
+	(junk) = __junk; \
+	} while (0)
+
+#define EVICTION_CALIBRATION_TRIALS 4 // Times every sampled set has to be evicted before a line count is accepted.
+#define EVICTION_CALIBRATION_STRIDE 16 // Sample every 16th set of the calibrated range.
+
+/**
+ * Find the minimal number of congruent lines that evicts a cached line from its set,
+ * i.e. the minimal eviction set for the D$ geometry and replacement policy, and store it for flushCache().
+ * Every sampled set of the range must be evicted in all trials, so the result is the maximum over the samples.
+ * The timed reload is the same mcycle sequence as in cacheAttack().
+ * @param memAddr starting address of the range that flushCache() will be asked to clear
+ * @param memSize size of that range in bytes
+ * @param threshold reload time below which a line counts as still cached
+ * @return number of lines per set that flushCache() will walk
+ */
+uint32_t calibrateEvictionSet(uint32_t memAddr, uint32_t memSize, uint32_t threshold){
+
+    evictionSetInit();
+
+    register uint32_t diff;
+    register uint8_t* target;
+    register uint8_t junk = 0;
+    for (uint32_t lines = 1; lines <= EVICTION_SET_MAX_LINES; ++lines){
+        uint32_t evicted = 1;
+        for (uint32_t offset = 0; evicted && offset < memSize; offset += EVICTION_CALIBRATION_STRIDE * L1_DCACHE_BLOCK_BYTES){
+            target = (uint8_t*)(memAddr + offset);
+            uint32_t setOffset = (memAddr + offset) & SET_MASK;
+            for (uint32_t trial = 0; trial < EVICTION_CALIBRATION_TRIALS; ++trial){
+                junk ^= *(volatile uint8_t*)target; // Bring the target into the cache.
+                for (uint32_t j = 0; j < lines; ++j){
+                    junk ^= *(volatile uint8_t*)(evictionBase[j] + setOffset);
+                }
+                TIMED_READ(diff, target, junk);
+                if (diff < threshold){
+                    evicted = 0; // Still cached, more lines are needed.
+                    break;
+                }
+            }
+        }
+        if (evicted){
+            evictionLines = lines;
+            flush_junk = junk;
+            return lines;
+        }
+    }
+    evictionLines = EVICTION_SET_MAX_LINES;
+    flush_junk = junk;
+    return EVICTION_SET_MAX_LINES;
+}
 
-// Set up an empty array to put into the cache during the following cache flush.
-// This aims to guarantee a contiguous set of addresses which is at least the size of cache.
-// TBD: Investigate how to determine this MULTIPLIER.
-#define MULTIPLIER 5 // At least 2. If the L1_DCACHE_WAYS is small, you will need a large value for this.
-// If your source codes are unable to flush the cache thoroughly, you may try increasing this MULTIPLIER.
-// But, of course, that will cause longer execution time of the final binary programs.
-uint8_t dummyMem[MULTIPLIER * L1_DCACHE_CAPACITY_BYTES];
-// Temporary variable.
-uint8_t flush_junk = 0;
 /**
  * Flush the cache of the address given since RISC-V does not have an x86 clflush type instruction.
- * Clears any set that has the same set bits as the input address range.
+ * Clears any set that has the same set bits as the input address range,
+ * by walking the evictionLines congruent lines per set found by calibrateEvictionSet().
  * Note: This does not work if you are trying to flush dummyMem out of the cache.
  * @param memAddr starting address to clear the cache
  * @param memSize size of the data to remove in bytes
@@ -65,29 +133,127 @@ void flushCache(uint32_t memAddr, uint32_t memSize){
         numSetsClear = L1_DCACHE_SETS;
     }
 
-    // This memory address alignedMem is the start of a contiguous set of memory that will fit inside the cache.
-    // Thus it has the following properties:
-    // 1. dummyMem <= alignedMem < dummyMem + sizeof(dummyMem) (since set bits and offset are cleared)
-    // 2. alignedMem has set bits = 0 and offset = 0, only tag bits remain.
-    uint32_t alignedMem = (((uint32_t)&dummyMem) + L1_DCACHE_CAPACITY_BYTES) & TAG_MASK;
-	// "&" is the address-of operator. The type of the result is "pointer to the operand."
-
-    for (uint32_t i = 0; i < numSetsClear; ++i){
-        // Combined with the for loop to move across the sets that you want to flush.
-        uint32_t setOffset = (((memAddr & SET_MASK) >> L1_DCACHE_BLOCK_BITS) + i) << L1_DCACHE_BLOCK_BITS;
-
-        // There are N=L1_DCACHE_WAYS in a set to flush. And it needs to be repeated for MULTIPLIER-1 times since we have an extended dummyMem.
-        for(uint32_t j = 0; j < ((MULTIPLIER-1)*L1_DCACHE_WAYS); ++j){
-        //for(uint32_t j = 0; j < L1_DCACHE_WAYS; ++j){
-            // offset to reaccess the set
-            uint32_t wayOffset = j << (L1_DCACHE_BLOCK_BITS + L1_DCACHE_SETS_BITS);
-
-            // The processor will fetch needed (but empty, this property is important) data into the cache
-			// as the following expression shows, which, due to same set bits and tags, evicts previous data.
-            flush_junk = *((uint8_t*)(alignedMem + setOffset + wayOffset));
-			// * indirection or dereferencing operator accesses the object the pointer points to.
+    // The range may wrap around the last set: split it into [setOffset, end of way) and [0, rest).
+    uint32_t setOffset = memAddr & SET_MASK;
+    uint32_t headBytes = numSetsClear << L1_DCACHE_BLOCK_BITS;
+    uint32_t tailBytes = 0;
+    if (setOffset + headBytes > L1_DCACHE_WAY_BYTES){
+        tailBytes = setOffset + headBytes - L1_DCACHE_WAY_BYTES;
+        headBytes = L1_DCACHE_WAY_BYTES - setOffset;
+    }
+
+    register uint8_t junk = 0;
+    for (uint32_t j = 0; j < evictionLines; ++j){
+        // The processor will fetch needed (but empty, this property is important) data into the cache
+        // as the following walk shows, which, due to same set bits and different tags, evicts previous data.
+        TOUCH_LINES(evictionBase[j] + setOffset, evictionBase[j] + setOffset + headBytes, junk);
+        TOUCH_LINES(evictionBase[j], evictionBase[j] + tailBytes, junk);
+    }
+    flush_junk = junk;
+}
+
+/**
+ * Prime the single set that addr maps to: after this walk it holds attacker lines from dummyMem only.
+ * flushCache() is the same walk over a whole range, which is why it doubles as the prime of the Prime+Probe receiver.
+ * @param memAddr any address within the set's line
+ */
+void primeSet(uint32_t memAddr){
+    register uint8_t junk = 0;
+    register uint32_t setOffset = memAddr & SET_MASK;
+    for (uint32_t j = 0; j < evictionLines; ++j){
+        junk ^= *(volatile uint8_t*)(evictionBase[j] + setOffset);
+    }
+    flush_junk = junk;
+}
+
+#define CALIBRATION_HIST_BINS 128 // Latency histogram resolution, 1 cycle per bin. Longer latencies land in the last bin.
+#define CALIBRATION_ROUNDS 8 // Flushes per calibration. Every flush yields one miss and one hit sample per sampled line.
+#define CALIBRATION_STRIDE 16 // Sample every 16th line of the calibrated range.
+#define CALIBRATION_TIMER_SAMPLES 16 // Back-to-back mcycle reads used to measure the cost of timing itself.
+
+uint16_t hitHistogram[CALIBRATION_HIST_BINS];
+uint16_t missHistogram[CALIBRATION_HIST_BINS];
+uint32_t timerOverhead = 0; // Cycles of an empty mcycle-bracketed region, found by calibrateHitThreshold().
+
+/**
+ * Measure the threshold that separates cached from flushed lines on this machine.
+ * Lines of the range are timed with the same mcycle sequence as cacheAttack(), right after flushCache() (misses)
+ * and right after that first access (hits). The net latencies, i.e. minus the cost of the timing instructions themselves,
+ * go into two histograms, and the threshold with the fewest misclassified samples is chosen.
+ * When several thresholds tie, the middle of them is taken for the widest margin on both sides.
+ * flushCache() is used with the full eviction set, so call this before calibrateEvictionSet().
+ * @param memAddr starting address of the range to sample, e.g. probeArray
+ * @param memSize size of that range in bytes
+ * @param fallback threshold returned when the histograms do not separate at all
+ * @return threshold in raw mcycle differences (net threshold + timerOverhead), to be compared directly against the timed reads
+ */
+uint32_t calibrateHitThreshold(uint32_t memAddr, uint32_t memSize, uint32_t fallback){
+
+    register uint32_t start, diff;
+    register uint8_t* target;
+    register uint8_t junk = 0;
+
+    // Cost of the timing instructions: minimum of back-to-back reads.
+    timerOverhead = FULL_MASK;
+    for (uint32_t i = 0; i < CALIBRATION_TIMER_SAMPLES; ++i){
+        start = READ_CSR(mcycle);
+        diff = (READ_CSR(mcycle) - start);
+        if (diff < timerOverhead){
+            timerOverhead = diff;
+        }
+    }
+
+    for (uint32_t bin = 0; bin < CALIBRATION_HIST_BINS; ++bin){
+        hitHistogram[bin] = 0;
+        missHistogram[bin] = 0;
+    }
+
+    evictionSetInit();
+    uint32_t samples = 0;
+    for (uint32_t round = 0; round < CALIBRATION_ROUNDS; ++round){
+        flushCache(memAddr, memSize);
+        for (uint32_t offset = 0; offset < memSize; offset += CALIBRATION_STRIDE * L1_DCACHE_BLOCK_BYTES){
+            target = (uint8_t*)(memAddr + offset);
+            for (uint32_t cached = 0; cached < 2; ++cached){
+                TIMED_READ(diff, target, junk);
+                diff = (diff > timerOverhead) ? diff - timerOverhead : 0;
+                if (diff >= CALIBRATION_HIST_BINS){
+                    diff = CALIBRATION_HIST_BINS - 1;
+                }
+                if (cached){
+                    hitHistogram[diff]++;
+                }
+                else {
+                    missHistogram[diff]++;
+                }
+            }
+            samples++;
         }
     }
+    flush_junk = junk;
+
+    // errors(t) = hits at or above t + misses below t. Start from t = 0, where every hit is misclassified.
+    uint32_t errors = samples;
+    uint32_t bestErrors = samples;
+    uint32_t bestFirst = 0;
+    uint32_t bestLast = 0;
+    for (uint32_t t = 1; t < CALIBRATION_HIST_BINS; ++t){
+        errors = errors - hitHistogram[t - 1] + missHistogram[t - 1];
+        if (errors < bestErrors){
+            bestErrors = errors;
+            bestFirst = t;
+            bestLast = t;
+        }
+        else if (errors == bestErrors && bestLast == t - 1){
+            bestLast = t;
+        }
+    }
+
+    // No threshold does better than calling everything a miss: the histograms overlap completely.
+    if (bestFirst == 0){
+        return fallback;
+    }
+    return (bestFirst + bestLast) / 2 + timerOverhead;
 }
 
 #endif
@@ -0,0 +1,111 @@
+#ifndef CACHE_CONF_H
+#define CACHE_CONF_H
+
+// Macros and static assertions only: this header is shared with the host-side tools in tools/, which can not include cache.h.
+
+// L1 data cache mapping for U Tokyo Shioya Lab RSD(RaiShouDou) CPU
+// Refer to https://github.com/rsd-devel/rsd/blob/master/Processor/Src/MicroArchConf.sv
+/**
+ * Geometry profiles, selected with L1_DCACHE_PROFILE, e.g. make DEFS="-DL1_DCACHE_PROFILE=L1_DCACHE_PROFILE_RSD_32KIB".
+ * Each one sets the MicroArchConf.sv parameters of an RSD configuration; everything below, dummyMem, probeArray,
+ * the flush bounds and the static assertions, derives from them.
+ * L1_DCACHE_PROFILE_CUSTOM takes L1_DCACHE_WAYS, L1_DCACHE_BLOCK_BITS and L1_DCACHE_SETS_BITS from the command line.
+ */
+#define L1_DCACHE_PROFILE_RSD_4KIB 0 // Default RSD: CONF_DCACHE_WAY_NUM = 2, CONF_DCACHE_LINE_BYTE_NUM = 8, CONF_DCACHE_INDEX_BIT_WIDTH = 9 - $clog2(2) = 8.
+#define L1_DCACHE_PROFILE_RSD_4KIB_4WAY 1 // CONF_DCACHE_WAY_NUM = 4: the same 4KiB, CONF_DCACHE_INDEX_BIT_WIDTH = 9 - $clog2(4) = 7.
+#define L1_DCACHE_PROFILE_RSD_32KIB 2 // 32KiB D$ with 2 ways of 8-byte lines, i.e. 2048 sets.
+#define L1_DCACHE_PROFILE_CUSTOM 3
+#ifndef L1_DCACHE_PROFILE
+#define L1_DCACHE_PROFILE L1_DCACHE_PROFILE_RSD_4KIB
+#endif
+
+#if L1_DCACHE_PROFILE == L1_DCACHE_PROFILE_RSD_4KIB
+#define L1_DCACHE_WAYS 2 // Degree of associativity N = 2. i.e. 2-way set associative. In the link above: "CONF_DCACHE_WAY_NUM = 2"
+#define L1_DCACHE_BLOCK_BITS 3 // = log2(b). b = 8Byte. In the link above: "CONF_DCACHE_LINE_BYTE_NUM = 8"
+#define L1_DCACHE_SETS_BITS 8 // = log2(S). In the link above: "CONF_DCACHE_INDEX_BIT_WIDTH = 9 - $clog2(CONF_DCACHE_WAY_NUM)"
+#elif L1_DCACHE_PROFILE == L1_DCACHE_PROFILE_RSD_4KIB_4WAY
+#define L1_DCACHE_WAYS 4
+#define L1_DCACHE_BLOCK_BITS 3
+#define L1_DCACHE_SETS_BITS 7
+#elif L1_DCACHE_PROFILE == L1_DCACHE_PROFILE_RSD_32KIB
+// Ref: S=B/N=C/Nb. C=32KiB, L1_DCACHE_WAYS=N=2, b=8Byte, S=32KiB/(2x8Byte)=2KB=2048B.
+#define L1_DCACHE_WAYS 2
+#define L1_DCACHE_BLOCK_BITS 3
+#define L1_DCACHE_SETS_BITS 11
+#ifndef MULTIPLIER
+#define MULTIPLIER 1 // dummyMem is then 2 ways of 16KiB. With 2 (64KiB) it does not fit next to probeArray and results().
+#endif
+#elif L1_DCACHE_PROFILE == L1_DCACHE_PROFILE_CUSTOM
+#if !defined(L1_DCACHE_WAYS) || !defined(L1_DCACHE_BLOCK_BITS) || !defined(L1_DCACHE_SETS_BITS)
+#error "L1_DCACHE_PROFILE_CUSTOM needs -DL1_DCACHE_WAYS=, -DL1_DCACHE_BLOCK_BITS= and -DL1_DCACHE_SETS_BITS=."
+#endif
+#else
+#error "Unknown L1_DCACHE_PROFILE."
+#endif
+
+#define L1_DCACHE_BLOCK_BYTES (1 << L1_DCACHE_BLOCK_BITS) // b, a power of 2 by construction.
+#define L1_DCACHE_SETS (1 << L1_DCACHE_SETS_BITS) // S = 2^L1_DCACHE_SETS_BITS, a power of 2 by construction.
+#define L1_DCACHE_CAPACITY_BYTES (L1_DCACHE_SETS*L1_DCACHE_WAYS*L1_DCACHE_BLOCK_BYTES) // Cache Capacity C=Bb=SNb, e.g. 256*2*8Byte=4KiB
+#define FULL_MASK 0xFFFFFFFF // The address size is 32 bits. Refer to https://github.com/rsd-devel/rsd/blob/master/Processor/Src/BasicTypes.sv "ADDR_WIDTH = 32"
+/**
+ * Sv39 virtual memory translation:
+ * Instruction fetch addresses and load and store effective addresses, which are 64 bits,
+ * must have bits 63–39 all equal to bit 38, or else a page-fault exception will occur.
+ */
+#define OFFSET_MASK (~(FULL_MASK << L1_DCACHE_BLOCK_BITS)) // Offset bits are 0 to (L1_DCACHE_BLOCK_BITS - 1).
+// After this definition, only offset bits remain 1, and they are used to discover existence of any cache set in use.
+#define TAG_MASK (FULL_MASK << (L1_DCACHE_SETS_BITS + L1_DCACHE_BLOCK_BITS))
+// After this definition, only tag bits remain 1, and they are used to align memory.
+#define SET_MASK (~(TAG_MASK | OFFSET_MASK))
+// After this definition, only set bits remain 1, and they are used to clear tag and offset field of input addr.
+
+/* ----------------------------------
+ * | Cache fields for a mapped memory address |
+ * The LSBs (Least Significant Bits) of the address specify which set holds the data.
+ * - Block offset. 32-bit RISC-V processors do not need "byte offset" for 32-bit addresses.
+ * - The next several bits are called the "set bits" because they indicate the set to which the address maps.
+ * The remaining MSBs (Most Significant Bits) are the "tag" and indicate which of the many possible addresses is held in that set.
+ * ----------------------------------
+ * | Tag (within a set) |  Set bits (index of set)  |       Block offset     |
+ * ----------------------------------
+ * |   <--Remaining-->  |       <--log2(S) -->      |     <--log2(b) -->    |
+ * ----------------------------------
+ */
+
+#define L1_DCACHE_WAY_BYTES (L1_DCACHE_SETS*L1_DCACHE_BLOCK_BYTES) // One way of the cache, i.e. all sets once: S*b=256*8Byte=2KiB
+
+// Size of dummyMem in cache.h, the memory that flushCache() fills the cache with.
+#ifndef MULTIPLIER
+#define MULTIPLIER 2 // At least 1. Eviction lines per set tried by calibrateEvictionSet() are at most MULTIPLIER*L1_DCACHE_WAYS.
+#endif
+// If calibrateEvictionSet() reports EVICTION_SET_MAX_LINES, the cache may not be flushed thoroughly, and you may try increasing this MULTIPLIER.
+// But, of course, that will cause a larger dummyMem.
+#define EVICTION_SET_MAX_LINES (MULTIPLIER * L1_DCACHE_WAYS)
+
+// The start-up code sets sp to ram_start + 128KiB (lui sp, 0x80020), so .data, .bss and the stack share 128KiB.
+#define RSD_RAM_BYTES 0x20000
+#define RSD_RAM_RESERVE_BYTES 0x4000 // Left for the stack and the small variables.
+
+/**
+ * Fast boot: the large buffers (dummyMem, probeArray, guideArray, tempArray) are RSD_NOINIT, i.e. in .noinit,
+ * which the loader of the start-up code (_load) neither copies from ROM nor clears. Otherwise they end up in .bss
+ * (about 25KiB with the default geometry, see code.dump), which _load clears one byte at a time before main().
+ * Whatever contents matter are written by bootArrays() in leak.h. FAST_BOOT 0 puts them back where the loader clears them.
+ */
+#ifndef FAST_BOOT
+#define FAST_BOOT 1
+#endif
+#if FAST_BOOT
+#define RSD_NOINIT __attribute__((section(".noinit")))
+#else
+#define RSD_NOINIT
+#endif
+
+_Static_assert(L1_DCACHE_WAYS >= 1, "L1_DCACHE_WAYS must be at least 1");
+_Static_assert(L1_DCACHE_BLOCK_BITS >= 2, "a cache line must hold at least one 32-bit word");
+_Static_assert(L1_DCACHE_BLOCK_BITS + L1_DCACHE_SETS_BITS < 32, "offset and set bits must leave tag bits in a 32-bit address");
+_Static_assert(MULTIPLIER >= 1, "an eviction set needs at least L1_DCACHE_WAYS lines per set");
+_Static_assert(EVICTION_SET_MAX_LINES * L1_DCACHE_WAY_BYTES <= RSD_RAM_BYTES - RSD_RAM_RESERVE_BYTES,
+    "dummyMem does not fit into RAM with this geometry: lower MULTIPLIER");
+
+#endif
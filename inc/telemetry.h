@@ -0,0 +1,181 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+/**
+ * Per-phase cycle accounting of the attack loop in leak.h.
+ * Every phase boundary costs one READ_CSR(mcycle), and the cycles since the previous boundary are charged
+ * to the phase that just finished. Totals are kept per round, per byte and for the whole run,
+ * and are written as a compact record stream to outputAddr. Decode it on the host with tools/telemetry_decode.py.
+ *
+ * TELEMETRY 0: disabled, all hooks compile to nothing.
+ * TELEMETRY 1: one record per byte and one for the whole run.
+ * TELEMETRY 2: additionally one record per round (prints ~40 characters per round, which costs cycles itself).
+ */
+#ifndef TELEMETRY
+#define TELEMETRY 0
+#endif
+
+#define PHASE_FLUSH 0 // flushCache(), once per slice as the prime of the Prime+Probe receiver
+#define PHASE_INIT 1 // SENDER_PREPARE, e.g. victimFuncInit() or predictor training
+#define PHASE_VICTIM 2 // SENDER_TRANSMIT, e.g. victimFunc[len]()
+#define PHASE_PROBE 3 // cacheAttack() or primeProbeAttack()
+#define PHASE_NUM 4
+
+/**
+ * Record stream. Every record is one line starting with '@', followed by a record type and
+ * fixed-width lower-case hex fields without separators:
+ * @H vv pp                     header: format version, PHASE_NUM
+ * @A name                      attack program, its ATTACK_NAME in plain text (leak.h)
+ * @R bb rr [cccccccc]*PHASE_NUM round: byte index, round index, cycles per phase (TELEMETRY 2 only)
+ * @B bb vv rrrr ssss [cccccccc]*PHASE_NUM byte: byte index, decoded value, rounds (all slices), stray hits, cycles per phase
+ * @T [cccccccc]*PHASE_NUM tttttttt total: cycles per phase, cycles of the whole run
+ * @O vvvvvvvv                  cycles of an empty mcycle-bracketed region (timerOverhead)
+ * @C vvvvvvvv                  cache hit threshold in use, in raw mcycle differences
+ * @E vvvvvvvv                  eviction lines per set found by calibrateEvictionSet()
+ * @I vvvvvvvv                  mcycle once the attack buffers are ready, i.e. the boot cost (leak.h)
+ * @G vvvvvvvv                  background hits of all probe lines in BASELINE_ROUNDS rounds, see calibrateBackground()
+ * Streaming mode (STREAM_LENGTH in receiver.h) writes two more, whatever TELEMETRY is:
+ * @W bbbbbbbb llllllll oooooooo tttttttt stream window: base address, length, first offset of this run, mcycle
+ * @S oooooooo vv hh rrrr tttttttt stream byte: offset, decoded value, hits of its weakest slice, rounds, mcycle when decided
+ * In streaming mode the byte index of @R and @B is the offset modulo 256.
+ */
+#define TELEMETRY_VERSION 3 // 2: stray hits in @B. 3: 4-digit rounds in @B, as in @S.
+// Stray hits: hits counted in results() on any line other than the decoded one, summed over the slices of the byte.
+// That includes the architectural line (LEAK_ARCH_LINE), i.e. about one per round.
+
+void telemetryOutHex(uint32_t value, uint32_t digits){
+	for (int shift = (digits - 1) * 4; shift >= 0; shift -= 4){
+		*outputAddr = "0123456789abcdef"[(value >> shift) & 0xF];
+	}
+}
+
+#if STREAM_LENGTH
+
+void telemetryStreamStart(uint32_t base, uint32_t length, uint32_t offset){
+	*outputAddr = '@';
+	*outputAddr = 'W';
+	telemetryOutHex(base, 8);
+	telemetryOutHex(length, 8);
+	telemetryOutHex(offset, 8);
+	telemetryOutHex(READ_CSR(mcycle), 8);
+	*outputAddr = '\n';
+}
+
+// Written as soon as a byte is decided, so that a run cut off by the cycle cap can be resumed after the last record.
+void telemetryStreamByte(uint32_t offset, uint8_t value, uint32_t hits, uint32_t rounds){
+	*outputAddr = '@';
+	*outputAddr = 'S';
+	telemetryOutHex(offset, 8);
+	telemetryOutHex(value, 2);
+	telemetryOutHex(hits, 2);
+	telemetryOutHex(rounds, 4);
+	telemetryOutHex(READ_CSR(mcycle), 8);
+	*outputAddr = '\n';
+}
+
+#endif
+
+#if TELEMETRY
+
+uint32_t telemetryLast; // mcycle at the previous phase boundary.
+uint32_t telemetryRunStart; // mcycle when telemetryInit() was called.
+uint32_t telemetryRound[PHASE_NUM];
+uint32_t telemetryByte[PHASE_NUM];
+uint32_t telemetryTotal[PHASE_NUM];
+
+// Open a new accounting interval without charging the cycles before it to any phase.
+#define TELEMETRY_START() (telemetryLast = READ_CSR(mcycle))
+
+// Charge the cycles since the previous boundary to phase, and open the next interval.
+#define TELEMETRY_MARK(phase) do { \
+	uint32_t __now = READ_CSR(mcycle); \
+	telemetryRound[(phase)] += __now - telemetryLast; \
+	telemetryLast = __now; \
+	} while (0)
+
+void telemetryInit(){
+	*outputAddr = '@';
+	*outputAddr = 'H';
+	telemetryOutHex(TELEMETRY_VERSION, 2);
+	telemetryOutHex(PHASE_NUM, 2);
+	*outputAddr = '\n';
+	telemetryRunStart = READ_CSR(mcycle);
+}
+
+// Name the attack program, so that logs of different programs can be told apart.
+void telemetryAttack(const char* name){
+	*outputAddr = '@';
+	*outputAddr = 'A';
+	while (*name){
+		*outputAddr = *name++;
+	}
+	*outputAddr = '\n';
+}
+
+// One-off calibration result, see the record list above.
+void telemetryNote(char kind, uint32_t value){
+	*outputAddr = '@';
+	*outputAddr = kind;
+	telemetryOutHex(value, 8);
+	*outputAddr = '\n';
+}
+
+// Fold the current round into the byte totals. Call outside of any accounting interval.
+void telemetryEndRound(uint32_t byteIdx, uint32_t round){
+#if TELEMETRY >= 2
+	*outputAddr = '@';
+	*outputAddr = 'R';
+	telemetryOutHex(byteIdx, 2);
+	telemetryOutHex(round, 2);
+	for (uint32_t p = 0; p < PHASE_NUM; p++){
+		telemetryOutHex(telemetryRound[p], 8);
+	}
+	*outputAddr = '\n';
+#endif
+	for (uint32_t p = 0; p < PHASE_NUM; p++){
+		telemetryByte[p] += telemetryRound[p];
+		telemetryRound[p] = 0;
+	}
+}
+
+// Emit the byte record and fold it into the run totals.
+void telemetryEndByte(uint32_t byteIdx, uint8_t value, uint32_t rounds, uint32_t strayHits){
+	*outputAddr = '@';
+	*outputAddr = 'B';
+	telemetryOutHex(byteIdx, 2);
+	telemetryOutHex(value, 2);
+	telemetryOutHex(rounds, 4);
+	telemetryOutHex(strayHits, 4);
+	for (uint32_t p = 0; p < PHASE_NUM; p++){
+		telemetryOutHex(telemetryByte[p], 8);
+		telemetryTotal[p] += telemetryByte[p];
+		telemetryByte[p] = 0;
+	}
+	*outputAddr = '\n';
+}
+
+void telemetryEnd(){
+	uint32_t runCycles = READ_CSR(mcycle) - telemetryRunStart;
+	*outputAddr = '@';
+	*outputAddr = 'T';
+	for (uint32_t p = 0; p < PHASE_NUM; p++){
+		telemetryOutHex(telemetryTotal[p], 8);
+	}
+	telemetryOutHex(runCycles, 8);
+	*outputAddr = '\n';
+}
+
+#else
+
+#define TELEMETRY_START() ((void)0)
+#define TELEMETRY_MARK(phase) ((void)0)
+#define telemetryInit() ((void)0)
+#define telemetryAttack(name) ((void)0)
+#define telemetryNote(kind, value) ((void)(value)) // Still evaluates value, which may be a calibration call.
+#define telemetryEndRound(byteIdx, round) ((void)0)
+#define telemetryEndByte(byteIdx, value, rounds, strayHits) ((void)0)
+#define telemetryEnd() ((void)0)
+
+#endif
+
+#endif
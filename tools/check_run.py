@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""Check the captured serial log of one attack program against its expected output and cycle baseline, or record the baseline.
+
+Usage: check_run.py --attack A --secret S [--min-hits 5] [--tolerance 0.05] serial.log    (make check)
+       check_run.py --attack A --secret S --update serial.log                             (make update-ref, after a known-good run)
+
+The log comes from a TELEMETRY=1 build. The expected output is the same for every program and follows from --secret:
+===Start===, one "Value: c Hit: n" line per byte, ===End===. Hit counts depend on timing, so they are only held to --min-hits.
+The check fails when
+- the output without the '@' telemetry records differs from that, e.g. a wrong byte, or a run cut off by MaxTestCycles in cfg.xml,
+- a byte was decoded with fewer than --min-hits hits,
+- the run cycles or the cycles per byte of the @T record exceed the baseline perf.ref.<attack>.txt by more than --tolerance.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+import telemetry_decode
+
+REPO = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+BASELINE_KEYS = ["run cycles", "cycles/byte"]
+VALUE_LINE = re.compile(r"^Value: (.) Hit: (.)$", re.DOTALL)
+
+
+def serial_lines(lines):
+    """The plain serial output, without the telemetry records."""
+    return [line.rstrip("\n") for line in lines if not line.startswith("@")]
+
+
+def expected_lines(secret):
+    return ["===Start==="] + ["Value: %s Hit: *" % c for c in secret] + ["===End==="]
+
+
+def compare(serial, secret, min_hits):
+    """Failures of serial against the expected output, with the hit counts masked and checked against min_hits."""
+    failures = []
+    masked = []
+    for line in serial:
+        match = VALUE_LINE.match(line)
+        if not match:
+            masked.append(line)
+            continue
+        masked.append("Value: %s Hit: *" % match.group(1))
+        hits = ord(match.group(2)) - ord("0")
+        if hits < min_hits:
+            failures.append("%r decoded with %d hits, fewer than %d" % (match.group(1), hits, min_hits))
+    expected = expected_lines(secret)
+    if masked != expected:
+        first = next((i for i, (a, b) in enumerate(zip(masked, expected)) if a != b), min(len(masked), len(expected)))
+        failures.insert(0, "serial output differs from the expected one at line %d: %r instead of %r"
+                        % (first + 1, serial[first] if first < len(serial) else "<end>",
+                           expected[first] if first < len(expected) else "<end>"))
+    return failures
+
+
+def read_baseline(path):
+    baseline = {}
+    with open(path) as f:
+        for line in f:
+            key, sep, value = line.partition("=")
+            if sep and not line.startswith("#"):
+                baseline[key.strip()] = int(value)
+    return baseline
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("log", help="serial output of a TELEMETRY=1 run")
+    parser.add_argument("--attack", required=True, help="attack program of the run (ATTACK in the Makefile)")
+    parser.add_argument("--secret", required=True, help="expected secret string")
+    parser.add_argument("--min-hits", type=int, default=5, help="hits every byte needs at least")
+    parser.add_argument("--tolerance", type=float, default=0.05, help="allowed cycle increase over the baseline (0.05: 5%%)")
+    parser.add_argument("--update", action="store_true", help="write the baseline from this run")
+    args = parser.parse_args()
+    baseline_path = os.path.join(REPO, "perf.ref.%s.txt" % args.attack)
+
+    with open(args.log, errors="replace") as f:
+        lines = f.readlines()
+    serial = serial_lines(lines)
+    _, _, _, bytes_, total = telemetry_decode.parse(lines)
+    summary = telemetry_decode.summarize(bytes_, total, args.secret)
+
+    failures = compare(serial, args.secret, args.min_hits)
+    if not total:
+        failures.append("no @T record: the run did not finish (MaxTestCycles in cfg.xml?), or was not built with TELEMETRY=1")
+
+    if args.update:
+        if failures:
+            sys.exit("%s: not a known-good run, baseline left alone:\n  %s" % (args.attack, "\n  ".join(failures)))
+        with open(baseline_path, "w") as f:
+            f.write("# Written by make update-ref from a known-good TELEMETRY=1 run of %s, checked by make check.\n" % args.attack)
+            for key in BASELINE_KEYS:
+                f.write("%s = %d\n" % (key, summary[key]))
+        print("%s: updated %s: %s" % (args.attack, os.path.basename(baseline_path),
+                                      ", ".join("%s %d" % (key, summary[key]) for key in BASELINE_KEYS)))
+        return
+
+    if not os.path.exists(baseline_path):
+        failures.append("no cycle baseline %s: run make update-ref after a known-good run" % os.path.basename(baseline_path))
+    elif total:
+        baseline = read_baseline(baseline_path)
+        for key in BASELINE_KEYS:
+            limit = baseline[key] * (1.0 + args.tolerance)
+            status = "ok" if summary[key] <= limit else "REGRESSION"
+            print("%s %s: %d, baseline %d (%+.1f%%) %s" % (args.attack, key, summary[key], baseline[key],
+                                                          100.0 * (summary[key] - baseline[key]) / max(baseline[key], 1), status))
+            if summary[key] > limit:
+                failures.append("%s %d exceeds the baseline %d by more than %.0f%%"
+                                % (key, summary[key], baseline[key], 100.0 * args.tolerance))
+
+    if failures:
+        sys.exit("%s: check failed:\n  %s" % (args.attack, "\n  ".join(failures)))
+    print("%s: check passed" % args.attack)
+
+
+if __name__ == "__main__":
+    main()
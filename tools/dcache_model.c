@@ -0,0 +1,431 @@
+/**
+ * Host-native functional model of the RSD L1 D$ (geometry from inc/cache_conf.h).
+ * It replays the memory accesses of one attack run: flushCache() over the eviction set, the victim gadgets,
+ * and the timed probe of cacheAttack() in its probe order, and reports what the real run can not show directly:
+ * - probe lines that survive a flush (flush coverage),
+ * - probe lines that are evicted again before they are probed, and who evicted them (self-eviction),
+ * - other data sharing sets with the probe lines (conflicts),
+ * - the byte the receiver would decode if timing were perfect.
+ * "Hit" means resident here, timing noise is not modelled.
+ *
+ * Build: make tools/dcache_model    Usage: tools/dcache_model --help
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cache_conf.h"
+#include "probe_order.h"
+
+// Mirrors of the defaults in receiver.h.
+#define RESULT_ARRAY_SIZE 256
+#define ARRAY_SIZE_FACTOR RESULT_ARRAY_SIZE
+#define GUIDE_FILL_VALUE 1
+#define STACK_TOP 0x80020000u // lui sp, 0x80020 in the RSD start-up code.
+
+#define POLICY_LRU 0
+#define POLICY_FIFO 1
+#define POLICY_RANDOM 2
+
+// Memory regions of the program that the model tells apart.
+enum {
+	REGION_DUMMY, REGION_EVICTION_TABLE, REGION_GUIDE, REGION_PROBE, REGION_TEMP, REGION_RESULTS,
+	REGION_HITS, REGION_GLOBALS, REGION_STACK, REGION_SECRET, REGION_NUM, REGION_NONE = REGION_NUM
+};
+
+typedef struct {
+	const char* name; // As in the program, for nm lookups.
+	uint32_t start;
+	uint32_t size;
+} region_t;
+
+static region_t regions[REGION_NUM] = {
+	[REGION_DUMMY] = {"dummyMem", 0, EVICTION_SET_MAX_LINES * L1_DCACHE_WAY_BYTES},
+	[REGION_EVICTION_TABLE] = {"evictionBase", 0, 4 * EVICTION_SET_MAX_LINES},
+	[REGION_GUIDE] = {"guideArray", 0, ARRAY_SIZE_FACTOR},
+	[REGION_PROBE] = {"probeArray", 0, 0}, // PROBE_BYTES, set in main().
+	[REGION_TEMP] = {"tempArray", 0, 4 * ARRAY_SIZE_FACTOR},
+	[REGION_RESULTS] = {"results", 0, RESULT_ARRAY_SIZE},
+	[REGION_HITS] = {"hitTimes", 0, 16},
+	[REGION_GLOBALS] = {"anchorVar", 0, 64},
+	[REGION_STACK] = {"stack", STACK_TOP - 256, 256},
+	[REGION_SECRET] = {"secret", 0x2b00, 64},
+};
+
+typedef struct {
+	uint32_t tag;
+	uint32_t stamp; // Last use (LRU) or fill time (FIFO).
+	uint8_t valid;
+	uint8_t region;
+} line_t;
+
+static line_t cache[L1_DCACHE_SETS][L1_DCACHE_WAYS];
+static uint32_t now;
+static int policy = POLICY_LRU;
+static uint32_t rngState = 12345;
+
+// evictions[evictor][victim]: lines of victim region pushed out by an access to evictor region.
+static uint32_t evictions[REGION_NUM][REGION_NUM];
+static uint8_t probeEvictedBy[ARRAY_SIZE_FACTOR]; // Region that last evicted each probe line.
+static uint8_t probeLoaded[ARRAY_SIZE_FACTOR]; // Loaded by a victim call since the last flush.
+static uint32_t probeEvictedBeforeProbe[REGION_NUM]; // By evictor, between the victim's load and the probe of that line.
+// ARRAY_STRIDE and PROBE_OFFSET of receiver.h for the LEAK_BITS of the run, set in main().
+static uint32_t arrayStride = L1_DCACHE_BLOCK_BYTES;
+static uint32_t probeOffset = 0;
+
+static uint32_t xorshift(void){
+	rngState ^= rngState << 13;
+	rngState ^= rngState >> 17;
+	rngState ^= rngState << 5;
+	return rngState;
+}
+
+static uint32_t setOf(uint32_t addr){ return (addr & SET_MASK) >> L1_DCACHE_BLOCK_BITS; }
+static uint32_t tagOf(uint32_t addr){ return addr & TAG_MASK; }
+
+static int resident(uint32_t addr){
+	line_t* set = cache[setOf(addr)];
+	for (int w = 0; w < L1_DCACHE_WAYS; w++){
+		if (set[w].valid && set[w].tag == tagOf(addr)){
+			return 1;
+		}
+	}
+	return 0;
+}
+
+// One load or store: returns 1 on a hit. Misses allocate (RSD's D$ is write-allocate as far as the attack cares).
+static int access(uint32_t addr, int region){
+	line_t* set = cache[setOf(addr)];
+	now++;
+	for (int w = 0; w < L1_DCACHE_WAYS; w++){
+		if (set[w].valid && set[w].tag == tagOf(addr)){
+			if (policy == POLICY_LRU){
+				set[w].stamp = now;
+			}
+			return 1;
+		}
+	}
+	int victim = 0;
+	for (int w = 0; w < L1_DCACHE_WAYS; w++){
+		if (!set[w].valid){
+			victim = w;
+			goto fill;
+		}
+		if (set[w].stamp < set[victim].stamp){
+			victim = w;
+		}
+	}
+	if (policy == POLICY_RANDOM){
+		victim = xorshift() % L1_DCACHE_WAYS;
+	}
+	if (region < REGION_NUM && set[victim].region < REGION_NUM){
+		evictions[region][set[victim].region]++;
+	}
+	if (set[victim].region == REGION_PROBE){
+		uint32_t offset = (set[victim].tag | (setOf(addr) << L1_DCACHE_BLOCK_BITS)) - regions[REGION_PROBE].start - probeOffset;
+		uint32_t line = offset / arrayStride;
+		if (offset % arrayStride == 0 && line < ARRAY_SIZE_FACTOR){
+			probeEvictedBy[line] = (uint8_t)region;
+		}
+	}
+fill:
+	set[victim].valid = 1;
+	set[victim].tag = tagOf(addr);
+	set[victim].stamp = now;
+	set[victim].region = region;
+	return 0;
+}
+
+static void touch(int region, uint32_t offset){
+	access(regions[region].start + offset, region);
+}
+
+typedef struct {
+	int leakBits;
+	int rounds;
+	int evictLines;
+	int orderTable; // PROBE_ORDER_TABLE (1) or PROBE_ORDER_MIXER (0).
+	uint32_t mixerA, mixerB;
+	double leakProbability; // Chance that a victim call leaves its speculative trace.
+	const char* secret;
+	int verbose;
+} options_t;
+
+static uint32_t probeLine(uint32_t value){
+	return regions[REGION_PROBE].start + probeOffset + value * arrayStride;
+}
+
+// flushProbeLines(): flushCache(probeArray, PROBE_BYTES), i.e. evictionLines congruent lines of every set of the range,
+// or primeSet() on each probe line when they are spread.
+static void replayFlush(uint32_t values, int evictLines){
+	touch(REGION_STACK, 0xC0);
+	if (arrayStride == L1_DCACHE_BLOCK_BYTES){
+		uint32_t setOffset = regions[REGION_PROBE].start & SET_MASK;
+		for (int j = 0; j < evictLines; j++){
+			touch(REGION_EVICTION_TABLE, 4 * j);
+			for (uint32_t b = 0; b < values * arrayStride; b += L1_DCACHE_BLOCK_BYTES){
+				touch(REGION_DUMMY, j * L1_DCACHE_WAY_BYTES + ((setOffset + b) & (L1_DCACHE_WAY_BYTES - 1)));
+			}
+		}
+	}
+	else {
+		for (uint32_t v = 0; v < values; v++){
+			for (int j = 0; j < evictLines; j++){
+				touch(REGION_EVICTION_TABLE, 4 * j);
+				touch(REGION_DUMMY, j * L1_DCACHE_WAY_BYTES + (probeLine(v) & SET_MASK));
+			}
+		}
+	}
+	memset(probeLoaded, 0, sizeof(probeLoaded));
+}
+
+// victimFuncInit()/victimFunc_NN(): stores, the (possibly) speculative secret-dependent probe line, the architectural one.
+static void replayVictim(int slot, uint32_t secretOffset, uint32_t sliceValue, uint32_t archValue, const options_t* opt){
+	touch(REGION_STACK, 0x80);
+	touch(REGION_GLOBALS, 0); // shift_base, tempArrayIndex(Init), anchorVar
+	touch(REGION_TEMP, 4 * slot); // tempArray[slot] = targetIdx
+	if ((xorshift() % 1000000) < (uint32_t)(opt->leakProbability * 1000000)){
+		access(regions[REGION_SECRET].start + secretOffset, REGION_SECRET);
+		access(probeLine(sliceValue), REGION_PROBE);
+		probeLoaded[sliceValue] = 1;
+	}
+	touch(REGION_TEMP, 4 * slot); // tempArray[indexVar] = 0, then the architectural load
+	touch(REGION_GUIDE, 0);
+	access(probeLine(archValue), REGION_PROBE);
+	probeLoaded[archValue] = 1;
+	touch(REGION_GLOBALS, 0);
+}
+
+static int parseLayout(const char* path){
+	FILE* f = fopen(path, "r");
+	if (!f){
+		perror(path);
+		return -1;
+	}
+	char line[256], fields[4][128];
+	int found = 0;
+	while (fgets(line, sizeof(line), f)){
+		// Accept both "nm" (addr type name) and "nm -S" (addr size type name) output.
+		int count = sscanf(line, "%127s %127s %127s %127s", fields[0], fields[1], fields[2], fields[3]);
+		if (count < 3){
+			continue;
+		}
+		uint32_t addr = (uint32_t)strtoul(fields[0], NULL, 16);
+		const char* name = fields[count - 1];
+		for (int r = 0; r < REGION_NUM; r++){
+			if (strcmp(name, regions[r].name) == 0){
+				regions[r].start = addr;
+				found++;
+			}
+		}
+	}
+	fclose(f);
+	return found;
+}
+
+// Linker-like default: small globals at the start of RAM, then the arrays in definition order with their alignment.
+static void defaultLayout(void){
+	uint32_t addr = 0x80000000u;
+	regions[REGION_GLOBALS].start = addr;
+	addr += 0x400;
+	static const int order[] = {REGION_DUMMY, REGION_EVICTION_TABLE, REGION_GUIDE, REGION_PROBE, REGION_TEMP, REGION_RESULTS, REGION_HITS};
+	for (unsigned i = 0; i < sizeof(order) / sizeof(order[0]); i++){
+		int wayAligned = (order[i] == REGION_DUMMY || order[i] == REGION_PROBE || order[i] == REGION_RESULTS);
+		uint32_t align = wayAligned ? L1_DCACHE_WAY_BYTES : 4;
+		addr = (addr + align - 1) & ~(align - 1);
+		regions[order[i]].start = addr;
+		addr += regions[order[i]].size;
+	}
+}
+
+static void usage(const char* argv0){
+	fprintf(stderr,
+		"usage: %s [options]\n"
+		"  --policy lru|fifo|random   replacement policy (lru)\n"
+		"  --layout FILE              symbol addresses from nm [-S] of the built program (default: synthetic layout)\n"
+		"  --leak-bits 8|4|2|1        LEAK_BITS of the build (8)\n"
+		"  --rounds N                 ATTACK_ROUNDS (9)\n"
+		"  --evict-lines N            eviction lines per set found by calibrateEvictionSet() (%d)\n"
+		"  --order table|mixer        PROBE_ORDER: generated table of probe_order.h (default if it fits) or the MIXER formula\n"
+		"  --mixer A,B                MIXER_A, MIXER_B of the mixer order (65,1)\n"
+		"  --leak-prob P              chance that a victim call leaks (1.0)\n"
+		"  --secret STRING            bytes to leak (RISCV)\n"
+		"  --seed N                   seed for random replacement and leaks\n"
+		"  -v                         per-round details\n", argv0, L1_DCACHE_WAYS);
+}
+
+int main(int argc, char** argv){
+	options_t opt = {8, 9, L1_DCACHE_WAYS, PROBE_ORDER_MATCHES_GEOMETRY, 65, 1, 1.0, "RISCV", 0};
+	const char* layout = NULL;
+	for (int i = 1; i < argc; i++){
+		const char* arg = argv[i];
+		const char* val = (i + 1 < argc) ? argv[i + 1] : NULL;
+		if (!strcmp(arg, "-v")){ opt.verbose = 1; continue; }
+		if (!val){ usage(argv[0]); return 2; }
+		i++;
+		if (!strcmp(arg, "--policy")){
+			policy = !strcmp(val, "fifo") ? POLICY_FIFO : !strcmp(val, "random") ? POLICY_RANDOM : POLICY_LRU;
+		}
+		else if (!strcmp(arg, "--layout")){ layout = val; }
+		else if (!strcmp(arg, "--leak-bits")){ opt.leakBits = atoi(val); }
+		else if (!strcmp(arg, "--rounds")){ opt.rounds = atoi(val); }
+		else if (!strcmp(arg, "--evict-lines")){ opt.evictLines = atoi(val); }
+		else if (!strcmp(arg, "--order")){ opt.orderTable = strcmp(val, "mixer") != 0; }
+		else if (!strcmp(arg, "--mixer")){ sscanf(val, "%u,%u", &opt.mixerA, &opt.mixerB); }
+		else if (!strcmp(arg, "--leak-prob")){ opt.leakProbability = atof(val); }
+		else if (!strcmp(arg, "--secret")){ opt.secret = val; }
+		else if (!strcmp(arg, "--seed")){ rngState = (uint32_t)strtoul(val, NULL, 0) | 1; }
+		else { usage(argv[0]); return 2; }
+	}
+	if (opt.orderTable && !PROBE_ORDER_MATCHES_GEOMETRY){
+		fprintf(stderr, "probe_order.h was generated for another geometry, use --order mixer or make probe-order\n");
+		return 2;
+	}
+	int leakBitsValid = opt.leakBits == 8 || opt.leakBits == 4 || opt.leakBits == 2 || opt.leakBits == 1;
+	if (!leakBitsValid || opt.evictLines < 1 || opt.evictLines > EVICTION_SET_MAX_LINES){
+		usage(argv[0]);
+		return 2;
+	}
+
+	const uint32_t values = 1u << opt.leakBits;
+	if (opt.leakBits != 8 && values < L1_DCACHE_SETS){
+		arrayStride = L1_DCACHE_WAY_BYTES >> opt.leakBits;
+		probeOffset = arrayStride / 2;
+	}
+	regions[REGION_PROBE].size = values * arrayStride;
+	defaultLayout();
+	if (layout && parseLayout(layout) <= 0){
+		fprintf(stderr, "%s: no known symbols found\n", layout);
+		return 1;
+	}
+
+	static uint32_t order[RESULT_ARRAY_SIZE];
+	static const uint8_t* tables[9] = {[1] = probeOrder1, [2] = probeOrder2, [4] = probeOrder4, [8] = probeOrder8};
+	for (uint32_t i = 0; i < values; i++){
+		order[i] = opt.orderTable ? tables[opt.leakBits][i] : (i * opt.mixerA + opt.mixerB) & (values - 1);
+	}
+
+	const char* policyNames[] = {"lru", "fifo", "random"};
+	printf("D$: %d-way, %d sets, %d-byte lines, %s replacement, %d eviction lines per set, %s probe order\n",
+		L1_DCACHE_WAYS, L1_DCACHE_SETS, L1_DCACHE_BLOCK_BYTES, policyNames[policy], opt.evictLines, opt.orderTable ? "table" : "mixer");
+
+	// Conflicts: how many of the probed lines share a set with each region.
+	printf("\n%-14s %10s %8s %s\n", "region", "start", "bytes", "probe sets shared");
+	for (int r = 0; r < REGION_NUM; r++){
+		uint32_t shared = 0;
+		for (uint32_t v = 0; v < values; v++){
+			uint32_t probeSet = setOf(probeLine(v));
+			for (uint32_t b = 0; b < regions[r].size && r != REGION_PROBE && r != REGION_DUMMY; b += L1_DCACHE_BLOCK_BYTES){
+				if (setOf(regions[r].start + b) == probeSet){
+					shared++;
+					break;
+				}
+			}
+		}
+		printf("%-14s 0x%08x %8u %u%s\n", regions[r].name, regions[r].start, regions[r].size, shared,
+			(r == REGION_PROBE || r == REGION_DUMMY) ? " (n/a)" : "");
+	}
+
+	uint32_t flushResidue = 0, flushResidueMax = 0, flushes = 0;
+	uint32_t falsePositives = 0, secretMissed = 0, roundsTotal = 0, correct = 0;
+	size_t length = strlen(opt.secret);
+	printf("\n%4s %6s %6s %8s %8s\n", "byte", "secret", "model", "false+", "missed");
+	for (size_t len = 0; len < length; len++){
+		uint8_t secretByte = (uint8_t)opt.secret[len];
+		uint8_t decoded = 0;
+		uint32_t byteFalse = 0, byteMissed = 0;
+		for (int shift = 0; shift < 8; shift += opt.leakBits){
+			uint32_t sliceValue = (opt.leakBits == 8) ? secretByte : (secretByte >> shift) & (values - 1);
+			uint32_t archValue = (opt.leakBits == 8) ? GUIDE_FILL_VALUE : (GUIDE_FILL_VALUE >> shift) & (values - 1);
+			uint32_t counts[RESULT_ARRAY_SIZE] = {0};
+			uint32_t skipIdx = archValue; // LEAK_ARCH_LINE(shift)
+			uint32_t topIdx[2] = {0, 0}, topTimes[2] = {0, 0};
+			for (int round = 0; round < opt.rounds; round++){
+				replayFlush(values, opt.evictLines);
+				uint32_t residue = 0;
+				for (uint32_t v = 0; v < values; v++){
+					residue += resident(probeLine(v));
+				}
+				flushResidue += residue;
+				flushes++;
+				if (residue > flushResidueMax){
+					flushResidueMax = residue;
+				}
+
+				replayVictim(2, (uint32_t)len, sliceValue, archValue, &opt);
+				replayVictim(1, (uint32_t)len, sliceValue, archValue, &opt);
+
+				// Lines that a victim call loaded: anything lost before their probe is self-eviction, also within the victim calls.
+				touch(REGION_STACK, 0x40);
+				for (uint32_t i = 0; i < values; i++){
+					uint32_t v = order[i];
+					int hit = access(probeLine(v), REGION_PROBE);
+					if (probeLoaded[v] && !hit){
+						probeEvictedBeforeProbe[probeEvictedBy[v]]++;
+						byteMissed += (v == sliceValue);
+					}
+					if (hit){
+						uint32_t count = ++counts[v];
+						touch(REGION_RESULTS, v); // results[v]++
+						touch(REGION_HITS, 0); // hitIdx/hitTimes
+						// The top-two update of cacheAttack(), so that ties resolve the same way.
+						if (v == skipIdx){
+							// Counted, never a candidate.
+						}
+						else if (v == topIdx[0]){
+							topTimes[0] = count;
+						}
+						else if (count > topTimes[0]){
+							topIdx[1] = topIdx[0];
+							topTimes[1] = topTimes[0];
+							topIdx[0] = v;
+							topTimes[0] = count;
+						}
+						else if (v == topIdx[1] || count > topTimes[1]){
+							topIdx[1] = v;
+							topTimes[1] = count;
+						}
+						if (v != sliceValue && v != archValue){
+							byteFalse++;
+						}
+					}
+					if (opt.verbose && hit){
+						printf("  byte %zu shift %d round %d: hit line %u%s\n", len, shift, round, v,
+							v == sliceValue ? " (secret)" : v == archValue ? " (architectural)" : "");
+					}
+				}
+				roundsTotal++;
+			}
+			uint32_t best = topIdx[0];
+			// LEAK_ARCH_FALLBACK()
+			if (opt.leakBits == 8 ? topTimes[0] == 0 : topTimes[0] * 2 <= (uint32_t)opt.rounds){
+				best = archValue;
+			}
+			decoded |= (uint8_t)(best << shift);
+		}
+		falsePositives += byteFalse;
+		secretMissed += byteMissed;
+		correct += (decoded == secretByte);
+		printf("%4zu   0x%02x   0x%02x %8u %8u\n", len, secretByte, decoded, byteFalse, byteMissed);
+	}
+
+	printf("\nflush coverage: %.2f probe lines survive a flush on average, %u at most\n",
+		flushes ? (double)flushResidue / flushes : 0.0, flushResidueMax);
+	printf("decoded %u/%zu bytes, %u false-positive hits and %u missed secret lines in %u rounds\n",
+		correct, length, falsePositives, secretMissed, roundsTotal);
+
+	printf("\nevictions of probeArray lines by region (all / after the victim's load, before their probe):\n");
+	for (int r = 0; r < REGION_NUM; r++){
+		if (evictions[r][REGION_PROBE] || probeEvictedBeforeProbe[r]){
+			printf("  %-14s %u / %u\n", regions[r].name, evictions[r][REGION_PROBE], probeEvictedBeforeProbe[r]);
+		}
+	}
+	printf("evictions of other lines by probeArray:\n");
+	for (int r = 0; r < REGION_NUM; r++){
+		if (r != REGION_PROBE && evictions[REGION_PROBE][r]){
+			printf("  %-14s %u\n", regions[r].name, evictions[REGION_PROBE][r]);
+		}
+	}
+	return 0;
+}
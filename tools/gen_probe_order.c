@@ -0,0 +1,137 @@
+/**
+ * Generate inc/probe_order.h: the order in which cacheAttack() and primeProbeAttack() visit the probe lines,
+ * one table for every LEAK_BITS (2, 4, 16 and 256 lines), checked against the L1 D$ geometry of inc/cache_conf.h.
+ *
+ * probeArray and results() are both aligned to L1_DCACHE_WAY_BYTES in receiver.h, so probe line v maps to set v mod S,
+ * and results[v] to set (v / L1_DCACHE_BLOCK_BYTES) mod S. For every two consecutive probes a, b of a table:
+ * 1. b is not a neighbouring line of a, |a - b| > 1 (no next-line or adjacent-line prefetch pattern), nor in the same set,
+ * 2. b is not in the set of results[a], which a hit on a writes just before b is timed,
+ * 3. b - a differs from the step before it (no constant stride over three probes).
+ * Small tables can not meet all of them. Constraints are then dropped from the last one on, and the header says which hold.
+ * The tables are permutations of values: in sliced modes receiver.h spreads the lines ARRAY_STRIDE apart, which meets 1 and 2
+ * anyway and keeps 3 as it is.
+ *
+ * The tables only fit the geometry they were generated for, which the header records.
+ * Build and run: make probe-order [DEFS="-DL1_DCACHE_PROFILE=..."]
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "cache_conf.h"
+
+#define MAX_LINES 256
+#define CONSTRAINTS 3
+
+static uint32_t rngState = 0x9E3779B9u; // Fixed seed: the generated header must not change between runs.
+
+static uint32_t xorshift(void){
+	rngState ^= rngState << 13;
+	rngState ^= rngState >> 17;
+	rngState ^= rngState << 5;
+	return rngState;
+}
+
+// Whether b may follow a (and prev, when pos >= 2) under the first `enabled` constraints.
+static int allowed(const uint8_t* order, int pos, uint32_t b, int enabled){
+	if (pos == 0){
+		return 1;
+	}
+	uint32_t a = order[pos - 1];
+	if (enabled >= 1 && ((a > b ? a - b : b - a) <= 1 || a % L1_DCACHE_SETS == b % L1_DCACHE_SETS)){
+		return 0;
+	}
+	if (enabled >= 2 && b % L1_DCACHE_SETS == (a / L1_DCACHE_BLOCK_BYTES) % L1_DCACHE_SETS){
+		return 0;
+	}
+	if (enabled >= 3 && pos >= 2 && (int)b - (int)a == (int)a - (int)order[pos - 2]){
+		return 0;
+	}
+	return 1;
+}
+
+// Depth-first search with a shuffled candidate order per position, so that the result looks random to a stride detector.
+static int search(uint8_t* order, uint8_t* used, int pos, int lines, int enabled, long* budget){
+	if (pos == lines){
+		return 1;
+	}
+	if (--*budget < 0){
+		return 0;
+	}
+	uint8_t candidates[MAX_LINES];
+	for (int v = 0; v < lines; v++){
+		candidates[v] = (uint8_t)v;
+	}
+	for (int v = lines - 1; v > 0; v--){
+		int w = xorshift() % (v + 1);
+		uint8_t t = candidates[v];
+		candidates[v] = candidates[w];
+		candidates[w] = t;
+	}
+	for (int c = 0; c < lines; c++){
+		uint32_t b = candidates[c];
+		if (used[b] || !allowed(order, pos, b, enabled)){
+			continue;
+		}
+		order[pos] = (uint8_t)b;
+		used[b] = 1;
+		if (search(order, used, pos + 1, lines, enabled, budget)){
+			return 1;
+		}
+		used[b] = 0;
+	}
+	return 0;
+}
+
+// Returns the number of constraints the generated order meets.
+static int generate(uint8_t* order, int lines){
+	for (int enabled = CONSTRAINTS; enabled > 0; enabled--){
+		uint8_t used[MAX_LINES] = {0};
+		long budget = 1000000;
+		if (search(order, used, 0, lines, enabled, &budget)){
+			return enabled;
+		}
+	}
+	for (int v = 0; v < lines; v++){
+		order[v] = (uint8_t)v;
+	}
+	return 0;
+}
+
+int main(void){
+	static const char* names[CONSTRAINTS] = {"no adjacent lines", "not in the set of the last results() entry", "no constant stride"};
+	static uint8_t tables[9][MAX_LINES]; // By LEAK_BITS.
+	int met[9];
+	for (int bits = 8; bits >= 1; bits /= 2){
+		met[bits] = generate(tables[bits], 1 << bits);
+	}
+
+	printf("// Generated by tools/gen_probe_order.c from inc/cache_conf.h, do not edit. Regenerate with \"make probe-order\".\n");
+	printf("#ifndef PROBE_ORDER_H\n#define PROBE_ORDER_H\n\n");
+	printf("/**\n * Probe orders for the %d-set, %d-byte-line L1 D$, one per LEAK_BITS (probeOrder8 visits 256 lines).\n",
+		L1_DCACHE_SETS, L1_DCACHE_BLOCK_BYTES);
+	printf(" * They assume probeArray and results() aligned to L1_DCACHE_WAY_BYTES, see tools/gen_probe_order.c.\n");
+	printf(" * For another geometry, use PROBE_ORDER_MIXER or regenerate them. Consecutive probes meet:\n");
+	for (int bits = 8; bits >= 1; bits /= 2){
+		printf(" * - probeOrder%d:", bits);
+		if (met[bits] == 0){
+			printf(" none of the constraints");
+		}
+		for (int c = 0; c < met[bits]; c++){
+			printf("%s %s", c ? "," : "", names[c]);
+		}
+		printf(".\n");
+	}
+	printf(" */\n");
+	printf("#define PROBE_ORDER_SETS %d\n#define PROBE_ORDER_BLOCK_BYTES %d\n", L1_DCACHE_SETS, L1_DCACHE_BLOCK_BYTES);
+	printf("#define PROBE_ORDER_MATCHES_GEOMETRY (PROBE_ORDER_SETS == L1_DCACHE_SETS && PROBE_ORDER_BLOCK_BYTES == L1_DCACHE_BLOCK_BYTES)\n");
+	for (int bits = 8; bits >= 1; bits /= 2){
+		printf("\nconst uint8_t probeOrder%d[%d] = {", bits, 1 << bits);
+		for (int v = 0; v < (1 << bits); v++){
+			printf("%s%s%d", v ? "," : "", (v % 16 == 0) ? "\n\t" : " ", tables[bits][v]);
+		}
+		printf("\n};\n");
+	}
+	printf("\n#endif\n");
+	return 0;
+}
@@ -0,0 +1,212 @@
+#!/usr/bin/env python3
+"""Attribute the cycles of a simulator trace to the functions and source lines of code.dump.
+
+Usage: profile.py [--dump code.dump] [--lines N] [--folded out.folded] trace.log
+  e.g. profile.py --folded profile.folded kanata.log && flamegraph.pl profile.folded > profile.svg
+
+The trace is either the Kanata pipeline log of the RSD simulator (detected by its "Kanata" header) or a plain commit
+trace with one retired instruction per line, "<cycle> <pc>" in decimal and hex (--format commit).
+Every retired instruction is charged the cycles since the previous commit, so that the flat profile adds up to the
+simulated cycles between the first and the last commit; the cycles beyond the first are its stall cycles.
+From a Kanata log, two more counts come per PC:
+- misses: loads and stores that spent at least --miss-cycles in one of the memory stages (--mem-stages),
+- squashed: instructions flushed instead of retired, i.e. the ones that only ran transiently.
+Source lines need the line table in code.dump, i.e. objdump -S -l (OBJDUMP in the Makefile); without it
+the lines fall back to the function name.
+The call stacks of the folded output are rebuilt from the committed calls and returns.
+"""
+
+import argparse
+import collections
+import re
+import sys
+
+SYMBOL = re.compile(r"^([0-9a-f]+) <([^>]+)>:$")
+SECTION = re.compile(r"^Disassembly of section (\S+):$")
+CODE_SECTION = re.compile(r"^\.(text|init)(\..*)?$")  # code.dump also disassembles .data and .rodata as if they were code.
+LINE = re.compile(r"^(\S+):(\d+)(?: \(discriminator \d+\))?$")
+INSN = re.compile(r"^\s*([0-9a-f]+):\t[0-9a-f ]+\t(\S+)\s*(.*)$")
+KANATA_PC = re.compile(r"(?:0x)?([0-9a-fA-F]{4,8}):")
+MEMORY_OPS = re.compile(r"^(lb|lh|lw|lbu|lhu|flw|sb|sh|sw|fsw|c\.lw|c\.sw|c\.lwsp|c\.swsp)$")
+CALLS = ("jal", "jalr", "call")
+
+
+def parse_dump(lines):
+    """Return {pc: (function, source line, mnemonic)} for the instructions in the objdump -S [-l] listing."""
+    insns = {}
+    section, function, source = None, None, None
+    for line in lines:
+        line = line.rstrip("\n")
+        m = SECTION.match(line)
+        if m:
+            section = m.group(1)
+            continue
+        if section is None or not CODE_SECTION.match(section):
+            continue
+        m = SYMBOL.match(line)
+        if m:
+            function, source = m.group(2), None
+            continue
+        m = LINE.match(line)
+        if m:
+            source = "%s:%s" % (m.group(1).split("/")[-1], m.group(2))
+            continue
+        m = INSN.match(line)
+        if m and function is not None:
+            insns[int(m.group(1), 16)] = (function, source or function, m.group(2))
+    return insns
+
+
+def parse_commit_trace(lines):
+    """Yield (cycle, pc) of every retired instruction of a plain commit trace."""
+    for line in lines:
+        fields = line.split()
+        if len(fields) < 2:
+            continue
+        try:
+            yield int(fields[0]), int(fields[1], 16), None
+        except ValueError:
+            continue
+
+
+def parse_kanata(lines, mem_stages, miss_cycles):
+    """Yield (cycle, pc, event) from a Kanata log: event is None for a retired instruction, else "miss" or "squashed"."""
+    cycle = 0
+    pcs, stages = {}, {}
+    for line in lines:
+        fields = line.rstrip("\n").split("\t")
+        kind = fields[0]
+        try:
+            if kind == "C=":
+                cycle = int(fields[1])
+            elif kind == "C":
+                cycle += int(fields[1])
+            elif kind == "I":
+                stages[int(fields[1])] = []
+            elif kind == "L" and fields[2] == "0":
+                m = KANATA_PC.search(fields[3])
+                if m:
+                    pcs[int(fields[1])] = int(m.group(1), 16)
+            elif kind == "S" and fields[2] == "0":
+                stages.setdefault(int(fields[1]), []).append((fields[3], cycle))
+            elif kind == "R":
+                iid = int(fields[1])
+                pc = pcs.pop(iid, None)
+                timeline = stages.pop(iid, [])
+                if pc is None:
+                    continue
+                ends = [start for _, start in timeline[1:]] + [cycle]
+                if any(mem_stages.search(stage) and end - start >= miss_cycles
+                       for (stage, start), end in zip(timeline, ends)):
+                    yield cycle, pc, "miss"
+                yield cycle, pc, None if fields[3] == "0" else "squashed"
+        except (IndexError, ValueError):
+            continue
+
+
+class Profile:
+    def __init__(self, insns):
+        self.insns = insns
+        self.by_function = collections.defaultdict(collections.Counter)
+        self.by_line = collections.defaultdict(collections.Counter)
+        self.folded = collections.Counter()
+        self.stack = []
+        self.last_cycle = None
+        self.last_mnemonic = None
+
+    def where(self, pc):
+        return self.insns.get(pc, ("0x%08x" % pc, "0x%08x" % pc, ""))
+
+    def add(self, cycle, pc, event):
+        function, source, mnemonic = self.where(pc)
+        if event is not None:
+            if event == "squashed" or MEMORY_OPS.match(mnemonic):
+                self.by_function[function][event] += 1
+                self.by_line[source][event] += 1
+            return
+        cycles = 0 if self.last_cycle is None else cycle - self.last_cycle
+        self.last_cycle = cycle
+        self.follow_stack(function)
+        self.last_mnemonic = mnemonic
+        for counts in (self.by_function[function], self.by_line[source]):
+            counts["cycles"] += cycles
+            counts["stalls"] += max(cycles - 1, 0)
+            counts["retired"] += 1
+        self.folded[";".join(self.stack)] += cycles
+
+    def follow_stack(self, function):
+        """Keep the shadow call stack in step with the function of the instruction just retired."""
+        if self.stack and self.stack[-1] == function:
+            return
+        if self.last_mnemonic in CALLS or not self.stack:
+            self.stack.append(function)
+        elif function in self.stack:
+            # A return, possibly past frames whose calls or returns were not seen.
+            while self.stack[-1] != function:
+                self.stack.pop()
+        else:
+            self.stack[-1] = function  # A tail call or a jump.
+
+
+def print_table(header, rows):
+    widths = [max(len(str(cell)) for cell in column) for column in zip(header, *rows)]
+    for row in [header] + rows:
+        print("  ".join(str(cell).rjust(width) if i else str(cell).ljust(width)
+                        for i, (cell, width) in enumerate(zip(row, widths))))
+
+
+def flat_rows(table, total, limit=None):
+    rows = sorted(table.items(), key=lambda item: -item[1]["cycles"])[:limit]
+    return [[name, c["cycles"], "%.1f%%" % (100.0 * c["cycles"] / max(total, 1)), c["retired"], c["stalls"],
+             "%.2f" % (c["cycles"] / c["retired"]) if c["retired"] else "-", c["miss"], c["squashed"]]
+            for name, c in rows]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("trace", help="Kanata log or commit trace of the simulator run")
+    parser.add_argument("--dump", default="code.dump", help="objdump -S -l listing of the same build (code.dump)")
+    parser.add_argument("--format", choices=["auto", "kanata", "commit"], default="auto", help="trace format")
+    parser.add_argument("--lines", type=int, default=20, help="source lines to list, 0 for none")
+    parser.add_argument("--folded", help="also write folded stacks (frame;frame cycles) for flamegraph.pl to this file")
+    parser.add_argument("--mem-stages", default="^(?i:m)", help="regex of the Kanata stage names of the memory access")
+    parser.add_argument("--miss-cycles", type=int, default=10, help="cycles in one memory stage that count as a miss")
+    args = parser.parse_args()
+
+    with open(args.dump, errors="replace") as f:
+        insns = parse_dump(f)
+    if not insns:
+        sys.exit("no instructions found in %s" % args.dump)
+
+    profile = Profile(insns)
+    with open(args.trace, errors="replace") as f:
+        first = f.readline()
+        f.seek(0)
+        if args.format == "kanata" or (args.format == "auto" and first.startswith("Kanata")):
+            events = parse_kanata(f, re.compile(args.mem_stages), args.miss_cycles)
+        else:
+            events = parse_commit_trace(f)
+        for cycle, pc, event in events:
+            profile.add(cycle, pc, event)
+
+    total = sum(c["cycles"] for c in profile.by_function.values())
+    retired = sum(c["retired"] for c in profile.by_function.values())
+    if not retired:
+        sys.exit("no retired instructions found in %s" % args.trace)
+    print("%d cycles, %d instructions retired, %.2f cycles per instruction" % (total, retired, total / retired))
+    print()
+    header = ["cycles", "share", "retired", "stalls", "CPI", "misses", "squashed"]
+    print_table(["function"] + header, flat_rows(profile.by_function, total))
+    if args.lines:
+        print()
+        print_table(["source line"] + header, flat_rows(profile.by_line, total, args.lines))
+
+    if args.folded:
+        with open(args.folded, "w") as f:
+            for stack, cycles in sorted(profile.folded.items()):
+                if cycles:
+                    f.write("%s %d\n" % (stack, cycles))
+
+
+if __name__ == "__main__":
+    main()
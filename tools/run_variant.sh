@@ -0,0 +1,15 @@
+#!/bin/sh
+# Build this program with extra preprocessor definitions and run it on the RSD simulator.
+# The build log goes to stderr and the serial output of the run to stdout.
+#
+# usage: tools/run_variant.sh "<DEFS>"    e.g. tools/run_variant.sh "-DTELEMETRY=1 -DLEAK_BITS=4"
+#        ATTACK=pht tools/run_variant.sh "<DEFS>"    builds another attack program, see ATTACK in the Makefile.
+#        OPT=-O0 tools/run_variant.sh "<DEFS>"       builds at another optimization level, see OPT in the Makefile.
+#
+# RSD_SIM must hold the command that runs the freshly built program of this directory on the simulator
+# and prints its serial output, e.g. a small wrapper around the Verilator or ModelSim run target of RSD.
+set -e
+cd "$(dirname "$0")/.."
+: "${RSD_SIM:?set RSD_SIM to the command that runs this directory on the RSD simulator}"
+make -B ${ATTACK:+ATTACK="$ATTACK"} ${OPT:+OPT="$OPT"} DEFS="$1" >&2
+sh -c "$RSD_SIM"
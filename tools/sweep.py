@@ -0,0 +1,154 @@
+#!/usr/bin/env python3
+"""Build and run a grid of parameter variants on local RSD simulator instances in parallel, and write a CSV.
+
+Usage: sweep.py [-j N] [--defs "-DX=1"] [-o sweep.csv] [--keep] [--force] NAME=v1,v2,... [NAME=...]
+  e.g. sweep.py -j 8 ATTACK_ROUNDS=3,9,20 PROBE_ORDER=PROBE_ORDER_TABLE,PROBE_ORDER_MIXER AUTO_THRESHOLD=0 CACHE_HIT_THRESHOLD=36,40,45
+  MIXER_A/MIXER_B only matter with --defs "-DPROBE_ORDER=PROBE_ORDER_MIXER".
+
+Every variant is built with `make -B DEFS="-DNAME=value ... -DTELEMETRY=1"` (unless the grid or --defs set TELEMETRY)
+and run through RSD_SIM, exactly like tools/run_variant.sh does, but each worker has its own copy of this directory:
+make and the simulator write their outputs next to the sources. The copies are siblings of this directory (../<name>-sweep-<n>),
+so ../BuildC.inc.mk and ../lib.c resolve the same way as here. The run cycles come from the telemetry records.
+"""
+
+import argparse
+import concurrent.futures
+import csv
+import itertools
+import os
+import queue
+import re
+import shutil
+import subprocess
+import sys
+import threading
+import time
+
+import telemetry_decode
+
+REPO = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+COPY_IGNORE = shutil.ignore_patterns(".git", "bench", "_gate_build", "*.csv")
+
+
+def secret_string():
+    """SECRET_STRING as defined in inc/receiver.h."""
+    with open(os.path.join(REPO, "inc", "receiver.h")) as f:
+        for line in f:
+            if line.startswith("#define SECRET_STRING "):
+                return line.split('"')[1]
+    sys.exit("SECRET_STRING not found in inc/receiver.h")
+
+
+def parse_grid(specs):
+    """["A=1,2", "B=3"] -> [("A", ["1", "2"]), ("B", ["3"])]"""
+    grid = []
+    for spec in specs:
+        name, sep, values = spec.partition("=")
+        if not sep or not name or not values:
+            sys.exit("bad grid entry %r, expected NAME=v1,v2,..." % spec)
+        grid.append((name, values.split(",")))
+    return grid
+
+
+def run_variant(workdir, defs, sim, timeout):
+    """Build and run one variant in workdir. Returns (status, serial output, wall seconds)."""
+    start = time.monotonic()
+    build = subprocess.run(["make", "-B", "DEFS=" + defs], cwd=workdir,
+                           stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+    if build.returncode != 0:
+        return "build failed", build.stdout, time.monotonic() - start
+    try:
+        run = subprocess.run(["sh", "-c", sim], cwd=workdir, stdout=subprocess.PIPE,
+                             stderr=subprocess.DEVNULL, text=True, errors="replace", timeout=timeout)
+    except subprocess.TimeoutExpired as e:
+        output = e.stdout.decode("latin-1") if isinstance(e.stdout, bytes) else (e.stdout or "")
+        return "timeout", output, time.monotonic() - start
+    status = "ok" if run.returncode == 0 else "exit %d" % run.returncode
+    return status, run.stdout, time.monotonic() - start
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("grid", nargs="+", help="NAME=v1,v2,... one per swept preprocessor macro")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count(), help="parallel simulator instances (all cores)")
+    parser.add_argument("--defs", default="", help="extra DEFS for every variant")
+    parser.add_argument("-o", "--output", default="sweep.csv", help="CSV file to write")
+    parser.add_argument("--timeout", type=float, default=None, help="seconds before a simulator run is abandoned")
+    parser.add_argument("--keep", action="store_true", help="keep the per-worker copies of this directory")
+    parser.add_argument("--force", action="store_true",
+                        help="replace existing per-worker copies (e.g. kept with --keep) and an existing CSV file")
+    args = parser.parse_args()
+
+    sim = os.environ.get("RSD_SIM")
+    if not sim:
+        sys.exit("set RSD_SIM to the command that runs this directory on the RSD simulator")
+    secret = secret_string()
+    grid = parse_grid(args.grid)
+    names = [name for name, _ in grid]
+    variants = list(itertools.product(*[values for _, values in grid]))
+    jobs = max(1, min(args.jobs, len(variants)))
+
+    # One copy of the tree per worker, handed out through a queue so that no two builds share a directory.
+    # Directories in the way may hold the results of an earlier --keep sweep: only --force replaces them.
+    base = os.path.basename(REPO)
+    paths = [os.path.join(os.path.dirname(REPO), "%s-sweep-%d" % (base, n)) for n in range(jobs)]
+    in_use = [path for path in paths if os.path.exists(path) and (not os.path.isdir(path) or os.listdir(path))]
+    if os.path.exists(args.output):
+        in_use.append(args.output)
+    if in_use and not args.force:
+        sys.exit("refusing to overwrite %s: move them away or pass --force" % ", ".join(in_use))
+    workdirs = queue.Queue()
+    for workdir in paths:
+        if os.path.isdir(workdir):
+            shutil.rmtree(workdir)
+        elif os.path.exists(workdir):
+            os.remove(workdir)
+        shutil.copytree(REPO, workdir, ignore=COPY_IGNORE)
+        workdirs.put(workdir)
+
+    # Telemetry is needed for the run cycles, but a second -DTELEMETRY would be a redefinition warning in every build.
+    telemetry = [] if "TELEMETRY" in names or re.search(r"-D\s*TELEMETRY\b", args.defs) else ["-DTELEMETRY=1"]
+
+    rows = [None] * len(variants)
+    lock = threading.Lock()
+    done = [0]
+
+    def worker(index, values):
+        defs = " ".join(["-D%s=%s" % nv for nv in zip(names, values)] + telemetry + [args.defs]).strip()
+        workdir = workdirs.get()
+        try:
+            status, output, wall = run_variant(workdir, defs, sim, args.timeout)
+        finally:
+            workdirs.put(workdir)
+        _, _, _, bytes_, total = telemetry_decode.parse(output.splitlines())
+        summary = telemetry_decode.summarize(bytes_, total, secret)
+        if status == "ok" and summary["bytes"] < len(secret):
+            status = "incomplete"
+        rows[index] = list(values) + [
+            status, summary["decoded"], summary["correct bytes"], summary["correct bits"],
+            "%.4f" % (summary["correct bits"] / (8.0 * len(secret))), summary["rounds"], summary["stray hits/round"],
+            summary["run cycles"], summary["cycles/byte"], summary["bits/kcycle"], "%.1f" % wall]
+        with lock:
+            done[0] += 1
+            print("[%d/%d] %s: %s %r in %.1f s" % (done[0], len(variants), defs, status, summary["decoded"], wall),
+                  file=sys.stderr)
+
+    start = time.monotonic()
+    with concurrent.futures.ThreadPoolExecutor(max_workers=jobs) as pool:
+        list(pool.map(worker, range(len(variants)), variants))
+
+    with open(args.output, "w", newline="") as f:
+        writer = csv.writer(f)
+        writer.writerow(names + ["status", "decoded", "correct bytes", "correct bits", "accuracy", "rounds",
+                                 "stray hits/round", "run cycles", "cycles/byte", "bits/kcycle", "wall s"])
+        writer.writerows(rows)
+    print("%d variants on %d instances in %.1f s, written to %s"
+          % (len(variants), jobs, time.monotonic() - start, args.output), file=sys.stderr)
+
+    if not args.keep:
+        while not workdirs.empty():
+            shutil.rmtree(workdirs.get(), ignore_errors=True)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,303 @@
+#!/usr/bin/env python3
+"""Decode the telemetry record stream (see inc/telemetry.h) from a captured serial log into tables.
+
+Usage: telemetry_decode.py [--rounds] [--secret S] [serial.log ...]   (reads stdin when no file is given)
+       telemetry_decode.py --compare --secret S serial_a.log serial_b.log ...   (one summary row per run)
+       telemetry_decode.py --overhead --secret S baseline.log mitigated.log ...   (cost and residual leakage against the first run)
+       telemetry_decode.py --stream [--secret S] stream_0.log stream_1.log ...   (streaming mode, resumed runs in any order)
+       telemetry_decode.py --next-offset stream_*.log   (offset to pass as STREAM_RESUME_OFFSET, or the length when done)
+"""
+
+import argparse
+import sys
+
+PHASE_NAMES = ["flush", "init", "victim", "probe"]
+NOTE_NAMES = {
+    "A": "attack",
+    "O": "timer overhead (cycles)",
+    "C": "cache hit threshold (cycles)",
+    "E": "eviction lines per set",
+    "I": "boot cycles (reset to buffers ready)",
+    "G": "background hits (BASELINE_ROUNDS)",
+}
+
+
+def hex_fields(payload, widths):
+    """Split a fixed-width hex payload into integers."""
+    values = []
+    pos = 0
+    for width in widths:
+        field = payload[pos:pos + width]
+        if len(field) != width:
+            raise ValueError("truncated record")
+        values.append(int(field, 16))
+        pos += width
+    return values
+
+
+def parse(lines):
+    """Return (phase_num, notes, rounds, bytes, total) from the '@' records found in lines."""
+    version, phase_num = 2, len(PHASE_NAMES)
+    notes, rounds, bytes_, total = {}, [], [], None
+    for line in lines:
+        line = line.strip()
+        start = line.find("@")
+        if start < 0 or start + 1 >= len(line):
+            continue
+        kind, payload = line[start + 1], line[start + 2:]
+        try:
+            if kind == "H":
+                version, phase_num = hex_fields(payload, [2, 2])
+            elif kind == "R":
+                v = hex_fields(payload, [2, 2] + [8] * phase_num)
+                rounds.append({"byte": v[0], "round": v[1], "phases": v[2:]})
+            elif kind == "B":
+                if version >= 2:
+                    v = hex_fields(payload, [2, 2, 4 if version >= 3 else 2, 4] + [8] * phase_num)
+                    bytes_.append({"byte": v[0], "value": v[1], "rounds": v[2], "stray": v[3], "phases": v[4:]})
+                else:
+                    v = hex_fields(payload, [2, 2, 2] + [8] * phase_num)
+                    bytes_.append({"byte": v[0], "value": v[1], "rounds": v[2], "stray": None, "phases": v[3:]})
+            elif kind == "T":
+                v = hex_fields(payload, [8] * phase_num + [8])
+                total = {"phases": v[:phase_num], "run": v[phase_num]}
+            elif kind == "A":
+                notes[kind] = payload
+            elif kind in NOTE_NAMES:
+                notes[kind] = hex_fields(payload, [8])[0]
+        except ValueError:
+            # A record cut off by the simulator cycle cap, or plain output that happens to contain '@'.
+            continue
+    return phase_num, notes, rounds, bytes_, total
+
+
+def parse_stream(lines):
+    """Return (windows, bytes) from the @W and @S records of streaming mode. Each byte carries the window it came from."""
+    windows, bytes_ = [], []
+    for line in lines:
+        line = line.strip()
+        start = line.find("@")
+        if start < 0 or start + 1 >= len(line):
+            continue
+        kind, payload = line[start + 1], line[start + 2:]
+        try:
+            if kind == "W":
+                v = hex_fields(payload, [8, 8, 8, 8])
+                windows.append({"base": v[0], "length": v[1], "offset": v[2], "start": v[3], "end": v[3]})
+            elif kind == "S" and windows:
+                v = hex_fields(payload, [8, 2, 2, 4, 8])
+                bytes_.append({"offset": v[0], "value": v[1], "hits": v[2], "rounds": v[3], "window": len(windows) - 1})
+                windows[-1]["end"] = v[4]
+        except ValueError:
+            continue
+    return windows, bytes_
+
+
+def assemble_stream(paths):
+    """Merge the streaming logs of one window. Returns (base, length, {offset: byte}, cycles spent)."""
+    windows, bytes_ = [], []
+    for path in paths:
+        with open(path, errors="replace") as f:
+            w, b = parse_stream(f.readlines())
+        for byte in b:
+            byte["window"] += len(windows)
+        windows.extend(w)
+        bytes_.extend(b)
+    if not windows:
+        return None, 0, {}, 0
+    base, length = windows[0]["base"], windows[0]["length"]
+    if any(w["base"] != base or w["length"] != length for w in windows):
+        sys.exit("the logs stream different windows")
+    by_offset = {}
+    for byte in bytes_:
+        by_offset[byte["offset"]] = byte  # A later run that leaked the same offset again wins.
+    cycles = sum((w["end"] - w["start"]) & 0xFFFFFFFF for w in windows)
+    return base, length, by_offset, cycles
+
+
+def next_offset(length, by_offset):
+    """First offset that no log has decided yet."""
+    offset = 0
+    while offset < length and offset in by_offset:
+        offset += 1
+    return offset
+
+
+def print_stream(base, length, by_offset, cycles, secret):
+    missing = length - len(by_offset)
+    print("window 0x%08x + %d bytes, %d decided, %d missing" % (base, length, len(by_offset), missing))
+    for row in range(0, length, 16):
+        cells = [by_offset.get(o) for o in range(row, min(row + 16, length))]
+        print("%08x  %-47s  %s" % (base + row, " ".join("%02x" % c["value"] if c else "??" for c in cells),
+                                   "".join(printable(c["value"]) if c else "?" for c in cells)))
+    weak = sorted(by_offset.values(), key=lambda b: b["hits"])[:8]
+    if weak:
+        print()
+        print("weakest bytes: " + ", ".join("+%d (%d hits)" % (b["offset"], b["hits"]) for b in weak))
+    bits = 8 * len(by_offset)
+    if secret is not None:
+        expected = secret.encode("latin-1")
+        compared = [(b["value"], expected[o]) for o, b in by_offset.items() if o < len(expected)]
+        correct_bytes = sum(d == e for d, e in compared)
+        bits = sum(8 - bin(d ^ e).count("1") for d, e in compared)
+        print("%d/%d bytes and %d/%d bits correct against the secret"
+              % (correct_bytes, len(compared), bits, 8 * len(compared)))
+    if cycles:
+        print("%d cycles, %d cycles/byte, %.4f %sbits/kcycle"
+              % (cycles, cycles // max(len(by_offset), 1), 1000.0 * bits / cycles,
+                 "correct " if secret is not None else ""))
+
+
+def phase_names(phase_num):
+    return [PHASE_NAMES[p] if p < len(PHASE_NAMES) else "phase%d" % p for p in range(phase_num)]
+
+
+def printable(value):
+    return chr(value) if 0x20 <= value < 0x7F else "."
+
+
+def summarize(bytes_, total, secret):
+    """Accuracy and throughput of one run. Correct bits are counted against the expected secret, when given."""
+    decoded = bytes(b["value"] for b in bytes_)
+    expected = secret.encode("latin-1")[:len(decoded)] if secret is not None else decoded
+    correct_bytes = sum(d == e for d, e in zip(decoded, expected))
+    correct_bits = sum(8 - bin(d ^ e).count("1") for d, e in zip(decoded, expected))
+    run = total["run"] if total else 0
+    rounds = sum(b["rounds"] for b in bytes_)
+    stray = None if any(b["stray"] is None for b in bytes_) else sum(b["stray"] for b in bytes_)
+    phases = total["phases"] if total else [0] * len(PHASE_NAMES)
+    return {
+        "decoded": decoded.decode("latin-1"),
+        "bytes": len(decoded),
+        "correct bytes": correct_bytes,
+        "correct bits": correct_bits,
+        "rounds": rounds,
+        "stray hits/round": "%.2f" % (stray / rounds) if stray is not None and rounds else "-",
+        "victim cycles/round": phases[PHASE_NAMES.index("victim")] // max(rounds, 1) if len(phases) > 2 else "-",
+        "probe cycles/round": phases[PHASE_NAMES.index("probe")] // max(rounds, 1) if len(phases) > 3 else "-",
+        "run cycles": run,
+        "cycles/byte": run // max(len(decoded), 1),
+        "bits/kcycle": "%.4f" % (1000.0 * correct_bits / run) if run else "-",
+    }
+
+
+def overhead_rows(runs, secret):
+    """Victim and whole-run cycles of every run relative to the first one (the unmitigated baseline), with the leakage left."""
+    base = runs[0][2]
+
+    def relative(value, reference):
+        if not isinstance(value, int) or not isinstance(reference, int) or not reference:
+            return "-"
+        return "%+.1f%%" % (100.0 * (value - reference) / reference)
+
+    rows = []
+    for path, attack, summary in runs:
+        bits = 8 * summary["bytes"]
+        rows.append([path, attack, summary["victim cycles/round"],
+                     relative(summary["victim cycles/round"], base["victim cycles/round"]),
+                     summary["cycles/byte"], relative(summary["cycles/byte"], base["cycles/byte"]),
+                     repr(summary["decoded"]),
+                     "%d/%d" % (summary["correct bytes"], summary["bytes"]) if secret is not None else "-",
+                     "%.1f%%" % (100.0 * summary["correct bits"] / bits) if secret is not None and bits else "-"])
+    return rows
+
+
+def print_table(header, rows):
+    widths = [max(len(str(cell)) for cell in column) for column in zip(header, *rows)]
+    for row in [header] + rows:
+        print("  ".join(str(cell).rjust(width) for cell, width in zip(row, widths)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("logs", nargs="*", help="serial output captured from the simulator")
+    parser.add_argument("--rounds", action="store_true", help="also print the per-round table (TELEMETRY 2)")
+    parser.add_argument("--secret", help="expected secret string, to count correctly leaked bits")
+    parser.add_argument("--compare", action="store_true", help="print one summary row per log instead of the tables")
+    parser.add_argument("--overhead", action="store_true",
+                        help="print victim and run cycle overhead against the first log, with the leakage left in each")
+    parser.add_argument("--stream", action="store_true", help="assemble the bytes of streaming-mode logs by offset")
+    parser.add_argument("--next-offset", action="store_true", help="print the offset a resumed streaming run starts at")
+    args = parser.parse_args()
+
+    if args.stream or args.next_offset:
+        base, length, by_offset, cycles = assemble_stream(args.logs)
+        if args.next_offset:
+            print(next_offset(length, by_offset))
+            return
+        if base is None:
+            sys.exit("no stream records found (build with -DSTREAM_LENGTH=n)")
+        print_stream(base, length, by_offset, cycles, args.secret)
+        return
+
+    if args.overhead:
+        runs = []
+        for path in args.logs:
+            with open(path, errors="replace") as f:
+                _, notes, _, bytes_, total = parse(f.readlines())
+            runs.append((path, notes.get("A", "-"), summarize(bytes_, total, args.secret)))
+        if not runs:
+            sys.exit("--overhead needs at least one log, the first one is the baseline")
+        print_table(["run", "attack", "victim cycles/round", "victim overhead", "cycles/byte", "slowdown",
+                     "decoded", "correct bytes", "correct bits"], overhead_rows(runs, args.secret))
+        print()
+        print("A run without leakage decodes the architectural value, which still shares some bits with the secret.")
+        return
+
+    if args.compare:
+        rows = []
+        for path in args.logs:
+            with open(path, errors="replace") as f:
+                _, notes, _, bytes_, total = parse(f.readlines())
+            summary = summarize(bytes_, total, args.secret)
+            rows.append([path, notes.get("A", "-"), notes.get("I", "-")]
+                        + [repr(v) if k == "decoded" else v for k, v in summary.items()])
+        if not rows:
+            sys.exit("--compare needs at least one log")
+        print_table(["run", "attack", "boot cycles"] + list(summarize([], None, None).keys()), rows)
+        return
+
+    lines = []
+    for path in args.logs or ["-"]:
+        with (sys.stdin if path == "-" else open(path, errors="replace")) as f:
+            lines.extend(f.readlines())
+    phase_num, notes, rounds, bytes_, total = parse(lines)
+    names = phase_names(phase_num)
+
+    for kind, value in notes.items():
+        print("%s: %s" % (NOTE_NAMES[kind], value))
+    if notes:
+        print()
+
+    if args.rounds and rounds:
+        print_table(["byte", "round"] + names + ["sum"],
+                    [[r["byte"], r["round"]] + r["phases"] + [sum(r["phases"])] for r in rounds])
+        print()
+
+    if bytes_:
+        print_table(["byte", "value", "char", "rounds", "stray"] + names + ["sum", "per round"],
+                    [[b["byte"], "0x%02x" % b["value"], printable(b["value"]), b["rounds"],
+                      "-" if b["stray"] is None else b["stray"]] + b["phases"]
+                     + [sum(b["phases"]), sum(b["phases"]) // max(b["rounds"], 1)] for b in bytes_])
+
+    if bytes_ and args.secret is not None:
+        summary = summarize(bytes_, total, args.secret)
+        print()
+        print("decoded %r, %d/%d bytes and %d/%d bits correct, %s leaked bits per kilocycle"
+              % (summary["decoded"], summary["correct bytes"], summary["bytes"],
+                 summary["correct bits"], 8 * summary["bytes"], summary["bits/kcycle"]))
+
+    if total:
+        attack = sum(total["phases"])
+        print()
+        print_table(["phase", "cycles", "share"],
+                    [[name, cycles, "%.1f%%" % (100.0 * cycles / max(total["run"], 1))]
+                     for name, cycles in zip(names, total["phases"])]
+                    + [["other", total["run"] - attack, "%.1f%%" % (100.0 * (total["run"] - attack) / max(total["run"], 1))],
+                       ["run", total["run"], "100.0%"]])
+    elif not bytes_ and not notes:
+        sys.exit("no telemetry records found (build with -DTELEMETRY=1)")
+
+
+if __name__ == "__main__":
+    main()